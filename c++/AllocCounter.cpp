@@ -0,0 +1,115 @@
+#include "AllocCounter.h"
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long> s_NumMatAllocs( 0 );
+static std::atomic<long> s_NumHeapAllocs( 0 );
+
+// off by default: a thread is counted once it calls SetCounting( true )
+static thread_local bool s_CountThisThread = false;
+
+#ifdef _DEBUG
+
+//=======================================================================
+// count every heap block allocated by this program
+// (array new/delete and sized delete forward to these by default)
+void* operator new( size_t size )
+{
+	if ( s_CountThisThread )
+	{
+		s_NumHeapAllocs++;
+	}
+
+	void* p = std::malloc( size > 0 ? size : 1 );
+	if ( p == NULL )
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+//=======================================================================
+void operator delete( void* p ) noexcept
+{
+	std::free( p );
+}
+
+//=======================================================================
+// counts the data buffers of cv::Mat, then hands over to the default allocator
+class CountingMatAllocator : public cv::MatAllocator
+{
+public:
+	CountingMatAllocator( cv::MatAllocator* base )
+		: m_Base( base )
+	{}
+
+	cv::UMatData* allocate(
+		int dims,
+		const int* sizes,
+		int type,
+		void* data,
+		size_t* step,
+		int flags,
+		cv::UMatUsageFlags usageFlags ) const override
+	{
+		// user-provided data is not an allocation
+		if ( data == NULL && s_CountThisThread )
+		{
+			s_NumMatAllocs++;
+		}
+
+		return m_Base->allocate( dims, sizes, type, data, step, flags, usageFlags );
+	}
+
+	bool allocate( cv::UMatData* data, int accessFlags, cv::UMatUsageFlags usageFlags ) const override
+	{
+		return m_Base->allocate( data, accessFlags, usageFlags );
+	}
+
+	void deallocate( cv::UMatData* data ) const override
+	{
+		m_Base->deallocate( data );
+	}
+
+private:
+	cv::MatAllocator* m_Base;
+}; // CountingMatAllocator
+
+#endif // _DEBUG
+
+//=======================================================================
+void AllocCounter::Install()
+{
+#ifdef _DEBUG
+	static CountingMatAllocator allocator( cv::Mat::getDefaultAllocator() );
+
+	if ( cv::Mat::getDefaultAllocator() != &allocator )
+	{
+		cv::Mat::setDefaultAllocator( &allocator );
+	}
+#endif // _DEBUG
+} // Install
+
+//=======================================================================
+bool AllocCounter::SetCounting( const bool on )
+{
+	const bool prev = s_CountThisThread;
+	s_CountThisThread = on;
+	return prev;
+} // SetCounting
+
+//=======================================================================
+long AllocCounter::GetNumMatAllocs()
+{
+	return s_NumMatAllocs;
+}
+
+//=======================================================================
+long AllocCounter::GetNumHeapAllocs()
+{
+	return s_NumHeapAllocs;
+}
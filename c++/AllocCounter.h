@@ -0,0 +1,25 @@
+#pragma once
+
+//===================================================================================
+// Debug-build allocation counter, used to check that the frame loop doesn't
+// allocate once it's warmed up.
+// - image buffers: every cv::Mat data allocation, including the ones made inside OpenCV
+// - heap blocks: every operator new in this program (not in the OpenCV dll)
+// Only the threads that turned counting on are counted: the frame loop, not the
+// capture, decode and encode threads that hand frames over through their rings.
+// In release builds nothing is counted and the counts stay at 0.
+//===================================================================================
+class AllocCounter
+{
+public:
+	// route cv::Mat allocations through the counter. Safe to call more than once
+	static void Install();
+
+	// count the calling thread's allocations, or not. @return the previous setting,
+	// to put back after a call that's known to allocate
+	static bool SetCounting( const bool on );
+
+	static long GetNumMatAllocs();
+
+	static long GetNumHeapAllocs();
+}; // AllocCounter
@@ -0,0 +1,218 @@
+#include "AsyncFrameWriter.h"
+
+//=======================================================================
+AsyncFrameWriter::AsyncFrameWriter()
+	: m_Policy( BLOCK )
+	, m_Head( 0 )
+	, m_Count( 0 )
+	, m_Busy( false )
+	, m_Stop( false )
+	, m_MaxCount( 0 )
+	, m_NumWritten( 0 )
+	, m_NumDropped( 0 )
+	, m_TotalEncodeTime( 0.0 )
+	, m_MaxEncodeTime( 0.0 )
+{}
+
+//=======================================================================
+AsyncFrameWriter::~AsyncFrameWriter()
+{
+	Stop();
+}
+
+//=======================================================================
+void AsyncFrameWriter::Start( const Encoder& encoder, const unsigned int depth, const POLICY policy )
+{
+	Stop();
+
+	const unsigned int n = depth < 1 ? 1 : depth;
+
+	m_Encoder = encoder;
+	m_Policy = policy;
+
+	// the slots keep their buffers from the previous run, if any
+	m_Slots.resize( n );
+	m_Infos.assign( n, FrameInfo() );
+	m_Head = 0;
+	m_Count = 0;
+	m_Busy = false;
+	m_Stop = false;
+
+	m_MaxCount = 0;
+	m_NumWritten = 0;
+	m_NumDropped = 0;
+	m_TotalEncodeTime = 0.0;
+	m_MaxEncodeTime = 0.0;
+
+	m_Thread = std::thread( &AsyncFrameWriter::WriteLoop, this );
+} // Start
+
+//=======================================================================
+void AsyncFrameWriter::Stop()
+{
+	if ( !m_Thread.joinable() )
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+		m_Stop = true;
+	}
+
+	// the writer drains the queue before it exits
+	m_NotEmpty.notify_all();
+	m_NotFull.notify_all();
+
+	m_Thread.join();
+} // Stop
+
+//=======================================================================
+bool AsyncFrameWriter::Push( const cv::Mat& frame, const FrameInfo& info )
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	const unsigned int n = static_cast<unsigned int>( m_Slots.size() );
+
+	if ( n == 0 || m_Stop )
+	{
+		return false; // not started
+	}
+
+	if ( m_Count == n )
+	{
+		switch ( m_Policy )
+		{
+		case BLOCK:
+			m_NotFull.wait( lock, [this, n]() { return m_Count < n || m_Stop; } );
+			if ( m_Count == n )
+			{
+				m_NumDropped++; // stopped while waiting
+				return false;
+			}
+			break;
+		case DROP_OLDEST:
+			m_Head = ( m_Head + 1 ) % n;
+			m_Count--;
+			m_NumDropped++;
+			break;
+		case DROP_NEWEST:
+		default:
+			m_NumDropped++;
+			return false;
+		}
+	}
+
+	// the slot keeps its buffer, so this only allocates on the first laps
+	const unsigned int slot = ( m_Head + m_Count ) % n;
+	frame.copyTo( m_Slots[slot] );
+	m_Infos[slot] = info;
+
+	m_Count++;
+	if ( m_Count > m_MaxCount )
+	{
+		m_MaxCount = m_Count;
+	}
+
+	lock.unlock();
+	m_NotEmpty.notify_one();
+
+	return true;
+} // Push
+
+//=======================================================================
+void AsyncFrameWriter::Flush()
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+	m_Idle.wait( lock, [this]() { return ( m_Count == 0 && !m_Busy ) || !m_Thread.joinable(); } );
+} // Flush
+
+//=======================================================================
+void AsyncFrameWriter::WriteLoop()
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	while ( true )
+	{
+		m_NotEmpty.wait( lock, [this]() { return m_Count > 0 || m_Stop; } );
+
+		if ( m_Count == 0 )
+		{
+			break; // stopped, and nothing left to write
+		}
+
+		// take the oldest frame out of the ring without copying it.
+		// the slot gets the previous encode buffer, to be reused by Push()
+		cv::swap( m_Slots[m_Head], m_EncodeFrame );
+		const FrameInfo info = m_Infos[m_Head];
+
+		m_Head = ( m_Head + 1 ) % m_Slots.size();
+		m_Count--;
+		m_Busy = true;
+
+		m_NotFull.notify_one();
+
+		// encode without holding the lock
+		lock.unlock();
+
+		const double start = FrameInfo::Now();
+		m_Encoder( m_EncodeFrame, info );
+		const double encodeTime = FrameInfo::Now() - start;
+
+		lock.lock();
+
+		m_NumWritten++;
+		m_TotalEncodeTime += encodeTime;
+		if ( encodeTime > m_MaxEncodeTime )
+		{
+			m_MaxEncodeTime = encodeTime;
+		}
+
+		m_Busy = false;
+		m_Idle.notify_all();
+	}
+
+	m_Idle.notify_all();
+} // WriteLoop
+
+//=======================================================================
+unsigned int AsyncFrameWriter::GetQueueDepth() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_Count;
+}
+
+//=======================================================================
+unsigned int AsyncFrameWriter::GetMaxQueueDepth() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_MaxCount;
+}
+
+//=======================================================================
+long AsyncFrameWriter::GetNumWritten() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_NumWritten;
+}
+
+//=======================================================================
+long AsyncFrameWriter::GetNumDropped() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_NumDropped;
+}
+
+//=======================================================================
+double AsyncFrameWriter::GetAvgEncodeTime() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_NumWritten > 0 ? m_TotalEncodeTime / m_NumWritten : 0.0;
+}
+
+//=======================================================================
+double AsyncFrameWriter::GetMaxEncodeTime() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_MaxEncodeTime;
+}
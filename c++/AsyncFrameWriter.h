@@ -0,0 +1,97 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "FrameInfo.h"
+
+//===================================================================================
+// Writes (encodes) output frames on a background thread, so the frame loop only
+// pays for a copy into a bounded queue of preallocated slots.
+// When the queue is full the policy decides: wait for the writer (BLOCK), overwrite
+// the oldest queued frame (DROP_OLDEST), or discard the frame being pushed (DROP_NEWEST).
+//===================================================================================
+class AsyncFrameWriter
+{
+public:
+	enum POLICY { BLOCK = 0, DROP_OLDEST, DROP_NEWEST };
+
+	// encodes one frame, called on the writer thread
+	typedef std::function<void( const cv::Mat& frame, const FrameInfo& info )> Encoder;
+
+	AsyncFrameWriter();
+
+	// writes out whatever is still queued
+	~AsyncFrameWriter();
+
+	// start the writer thread with a queue of "depth" frames
+	void Start( const Encoder& encoder, const unsigned int depth, const POLICY policy );
+
+	// write out everything queued, then stop the writer thread
+	void Stop();
+
+	bool IsRunning() const
+	{
+		return m_Thread.joinable();
+	}
+
+	// @brief: queue a copy of frame to be encoded
+	// @return false if the frame was dropped (DROP_NEWEST, queue full)
+	bool Push( const cv::Mat& frame, const FrameInfo& info );
+
+	// wait until everything queued so far is written
+	void Flush();
+
+	//=======================================
+	// statistics
+	//=======================================
+
+	// number of frames waiting in the queue now
+	unsigned int GetQueueDepth() const;
+
+	unsigned int GetMaxQueueDepth() const;
+
+	long GetNumWritten() const;
+
+	// frames discarded because the queue was full
+	long GetNumDropped() const;
+
+	// average encode time per frame, ms
+	double GetAvgEncodeTime() const;
+
+	double GetMaxEncodeTime() const;
+
+private:
+	// writer thread body
+	void WriteLoop();
+
+	Encoder						m_Encoder;
+	POLICY						m_Policy;
+
+	std::vector<cv::Mat>		m_Slots;		// ring of queued frames
+	std::vector<FrameInfo>		m_Infos;		// envelope of each slot
+	unsigned int				m_Head;			// slot of the oldest queued frame
+	unsigned int				m_Count;		// number of queued frames
+	bool						m_Busy;			// the writer is encoding a frame
+	bool						m_Stop;
+
+	cv::Mat						m_EncodeFrame;	// frame being encoded, swapped with a slot
+
+	unsigned int				m_MaxCount;
+	long						m_NumWritten;
+	long						m_NumDropped;
+	double						m_TotalEncodeTime;	// ms
+	double						m_MaxEncodeTime;	// ms
+
+	std::thread					m_Thread;
+
+	mutable std::mutex			m_Mutex;
+	std::condition_variable		m_NotEmpty;		// the writer waits for frames
+	std::condition_variable		m_NotFull;		// Push() waits for room (BLOCK)
+	std::condition_variable		m_Idle;			// Flush() waits for the writer
+}; // AsyncFrameWriter
@@ -0,0 +1,211 @@
+#include "BitMask.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//===================================================================================
+BitMask::BitMask()
+	: m_Width( 0 )
+	, m_Height( 0 )
+	, m_WordsPerRow( 0 )
+{}
+
+//===================================================================================
+void BitMask::Create( const cv::Size& size )
+{
+	m_Width = size.width;
+	m_Height = size.height;
+	m_WordsPerRow = ( size.width + 63 ) / 64;
+
+	// a smaller size keeps the capacity
+	m_Words.resize( static_cast<size_t>( m_WordsPerRow ) * m_Height );
+} // Create
+
+//===================================================================================
+uint64_t BitMask::PaddingBits() const
+{
+	const int used = m_Width % 64;
+	return used == 0 ? 0 : ~static_cast<uint64_t>( 0 ) << used;
+} // PaddingBits
+
+//===================================================================================
+void BitMask::Pack( const cv::Mat& bin )
+{
+	CV_Assert( bin.type() == CV_8UC1 );
+
+	Create( bin.size() );
+
+	for ( int y = 0; y < m_Height; y++ )
+	{
+		const uchar* p = bin.ptr<uchar>( y );
+		uint64_t* row = Row( y );
+
+		for ( int i = 0; i < m_WordsPerRow; i++, p += 64 )
+		{
+			const int n = std::min( 64, m_Width - 64 * i );
+
+			uint64_t w = 0;
+			for ( int b = 0; b < n; b++ )
+			{
+				w |= static_cast<uint64_t>( p[b] != 0 ) << b;
+			}
+			row[i] = w;
+		}
+	}
+} // Pack
+
+//===================================================================================
+void BitMask::Unpack( cv::Mat& bin ) const
+{
+	bin.create( m_Height, m_Width, CV_8UC1 );
+
+	for ( int y = 0; y < m_Height; y++ )
+	{
+		uchar* p = bin.ptr<uchar>( y );
+		const uint64_t* row = Row( y );
+
+		for ( int x = 0; x < m_Width; x++ )
+		{
+			p[x] = ( row[x >> 6] >> ( x & 63 ) ) & 1 ? 255 : 0;
+		}
+	}
+} // Unpack
+
+//===================================================================================
+void BitMask::And( const BitMask& other )
+{
+	CV_Assert( other.m_Width == m_Width && other.m_Height == m_Height );
+
+	for ( size_t i = 0; i < m_Words.size(); i++ )
+	{
+		m_Words[i] &= other.m_Words[i];
+	}
+} // And
+
+//===================================================================================
+void BitMask::Or( const BitMask& other )
+{
+	CV_Assert( other.m_Width == m_Width && other.m_Height == m_Height );
+
+	for ( size_t i = 0; i < m_Words.size(); i++ )
+	{
+		m_Words[i] |= other.m_Words[i];
+	}
+} // Or
+
+//===================================================================================
+void BitMask::Erode( const BitMask& src )
+{
+	Morph( src, true );
+} // Erode
+
+//===================================================================================
+void BitMask::Dilate( const BitMask& src )
+{
+	Morph( src, false );
+} // Dilate
+
+//===================================================================================
+void BitMask::Morph( const BitMask& src, const bool erode )
+{
+	CV_Assert( &src != this );
+
+	Create( cv::Size( src.m_Width, src.m_Height ) );
+
+	const int n = m_WordsPerRow;
+	const uint64_t outside = erode ? ~static_cast<uint64_t>( 0 ) : 0;
+	const uint64_t padding = PaddingBits() & outside; // past the width is outside
+
+	m_Span.resize( m_Words.size() );
+
+	// 1. every row spread over x -2..+2
+	for ( int y = 0; y < m_Height; y++ )
+	{
+		const uint64_t* s = src.Row( y );
+		uint64_t* span = &m_Span[static_cast<size_t>( y ) * n];
+
+		for ( int i = 0; i < n; i++ )
+		{
+			const uint64_t curr = i == n - 1 ? s[i] | padding : s[i];
+			const uint64_t prev = i > 0 ? s[i - 1] : outside;
+			const uint64_t next = i + 1 < n ? ( i + 1 == n - 1 ? s[i + 1] | padding : s[i + 1] ) : outside;
+
+			// pixel x gets x + 1, x + 2, x - 1, x - 2
+			const uint64_t r1 = ( curr >> 1 ) | ( next << 63 );
+			const uint64_t r2 = ( curr >> 2 ) | ( next << 62 );
+			const uint64_t l1 = ( curr << 1 ) | ( prev >> 63 );
+			const uint64_t l2 = ( curr << 2 ) | ( prev >> 62 );
+
+			span[i] = erode ?
+				curr & r1 & r2 & l1 & l2 :
+				curr | r1 | r2 | l1 | l2;
+		}
+	}
+
+	// 2. rows -1..+1 spread, rows -2 and +2 as they are. Rows outside are left out
+	for ( int y = 0; y < m_Height; y++ )
+	{
+		uint64_t* out = Row( y );
+		const uint64_t* span = &m_Span[static_cast<size_t>( y ) * n];
+
+		for ( int i = 0; i < n; i++ )
+		{
+			out[i] = span[i];
+		}
+
+		const int spanRows[2] = { y - 1, y + 1 };
+		for ( int k = 0; k < 2; k++ )
+		{
+			if ( spanRows[k] < 0 || spanRows[k] >= m_Height )
+			{
+				continue;
+			}
+
+			const uint64_t* other = &m_Span[static_cast<size_t>( spanRows[k] ) * n];
+			for ( int i = 0; i < n; i++ )
+			{
+				out[i] = erode ? out[i] & other[i] : out[i] | other[i];
+			}
+		}
+
+		const int srcRows[2] = { y - 2, y + 2 };
+		for ( int k = 0; k < 2; k++ )
+		{
+			if ( srcRows[k] < 0 || srcRows[k] >= m_Height )
+			{
+				continue;
+			}
+
+			const uint64_t* other = src.Row( srcRows[k] );
+			for ( int i = 0; i < n; i++ )
+			{
+				out[i] = erode ? out[i] & other[i] : out[i] | other[i];
+			}
+		}
+
+		// keep the bits past the width clear
+		out[n - 1] &= ~PaddingBits();
+	}
+} // Morph
+
+//===================================================================================
+int BitMask::CountTrailingZeros( const uint64_t w )
+{
+#if defined( _MSC_VER ) && defined( _M_X64 )
+	unsigned long i;
+	_BitScanForward64( &i, w );
+	return static_cast<int>( i );
+#elif defined( __GNUC__ )
+	return __builtin_ctzll( w );
+#else
+	int i = 0;
+	while ( ( ( w >> i ) & 1 ) == 0 )
+	{
+		i++;
+	}
+	return i;
+#endif
+} // CountTrailingZeros
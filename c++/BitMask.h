@@ -0,0 +1,83 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+//===================================================================================
+// A binary image with one bit per pixel, 64 pixels per word.
+// Bit i of word w of a row is pixel x = 64 * w + i; the bits past the width are 0.
+// Erode() and Dilate() use the 5x5 ellipse of cv::getStructuringElement( MORPH_ELLIPSE ):
+//   rows -1, 0, +1 span x -2..+2, rows -2 and +2 only x 0,
+// as shifts and ANDs/ORs of whole words. Like cv::morphologyEx, pixels outside the
+// image count as set when eroding and as clear when dilating, so the results are
+// the same as cv::erode / cv::dilate with that element.
+// Storage only grows, so a mask reused for smaller images doesn't reallocate.
+//===================================================================================
+class BitMask
+{
+public:
+	BitMask();
+
+	// resize, the content is undefined
+	void Create( const cv::Size& size );
+
+	int GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int GetHeight() const
+	{
+		return m_Height;
+	}
+
+	int GetWordsPerRow() const
+	{
+		return m_WordsPerRow;
+	}
+
+	uint64_t* Row( const int y )
+	{
+		return &m_Words[static_cast<size_t>( y ) * m_WordsPerRow];
+	}
+
+	const uint64_t* Row( const int y ) const
+	{
+		return &m_Words[static_cast<size_t>( y ) * m_WordsPerRow];
+	}
+
+	// the non-zero pixels of bin (CV_8UC1)
+	void Pack( const cv::Mat& bin );
+
+	// to 0 / 255 in bin (CV_8UC1), e.g. to show it
+	void Unpack( cv::Mat& bin ) const;
+
+	// this = this & other, this = this | other. Same size
+	void And( const BitMask& other );
+
+	void Or( const BitMask& other );
+
+	// this = src eroded / dilated by the 5x5 ellipse
+	void Erode( const BitMask& src );
+
+	void Dilate( const BitMask& src );
+
+	// index of the lowest set bit, w must not be 0
+	static int CountTrailingZeros( const uint64_t w );
+
+private:
+
+	// erode ( AND, outside set ) or dilate ( OR, outside clear )
+	void Morph( const BitMask& src, const bool erode );
+
+	// the bits past the width of the last word of a row
+	uint64_t PaddingBits() const;
+
+	std::vector<uint64_t>	m_Words;
+	std::vector<uint64_t>	m_Span;		// workspace: src with its rows spread over x -2..+2
+	int						m_Width;
+	int						m_Height;
+	int						m_WordsPerRow;
+}; // BitMask
@@ -0,0 +1,311 @@
+#include "BlobExtractor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const double PI = 3.14159265358979;
+
+	// 0 * 0 + 1 * 1 + ... + n * n
+	inline double SumOfSquares( const double n )
+	{
+		return n * ( n + 1.0 ) * ( 2.0 * n + 1.0 ) / 6.0;
+	}
+} // namespace
+
+//===================================================================================
+Blob::Blob()
+	: m_Area( 0 )
+	, m_SumX( 0.0 )
+	, m_SumY( 0.0 )
+	, m_SumXX( 0.0 )
+	, m_SumYY( 0.0 )
+	, m_SumXY( 0.0 )
+	, m_CrackLength( 0 )
+{}
+
+//===================================================================================
+void Blob::GetCovariance( double& xx, double& yy, double& xy ) const
+{
+	const cv::Point2d c = GetCentroid();
+
+	xx = m_SumXX / m_Area - c.x * c.x;
+	yy = m_SumYY / m_Area - c.y * c.y;
+	xy = m_SumXY / m_Area - c.x * c.y;
+} // GetCovariance
+
+//===================================================================================
+double Blob::GetStreak( cv::Point2d& dir, double& length ) const
+{
+	double xx, yy, xy;
+	GetCovariance( xx, yy, xy );
+
+	// the smallest eigenvalue of the covariance is the variance across the streak
+	const double minor = 0.5 * ( xx + yy ) - std::sqrt( 0.25 * ( xx - yy ) * ( xx - yy ) + xy * xy );
+
+	// the major axis is along it
+	const double angle = 0.5 * std::atan2( 2.0 * xy, xx - yy );
+	dir = cv::Point2d( std::cos( angle ), std::sin( angle ) );
+
+	// a stadium of radius r and length L: area = PI r^2 + 2 r L, and across it
+	// area * variance = PI r^4 / 4 + 2 L r^3 / 3. For a given area the variance grows
+	// with r (up to the disk, L = 0), so bisect r
+	const double area = m_Area;
+	double low = 0.0;
+	double high = std::sqrt( area / PI );
+
+	for ( int i = 0; i < 30; i++ )
+	{
+		const double r = 0.5 * ( low + high );
+		const double l = ( area - PI * r * r ) / ( 2.0 * r );
+		const double var = ( PI * r * r * r * r / 4.0 + 2.0 * l * r * r * r / 3.0 ) / area;
+
+		if ( var < minor )
+		{
+			low = r;
+		}
+		else
+		{
+			high = r;
+		}
+	}
+
+	const double r = 0.5 * ( low + high );
+	length = std::max( 0.0, ( area - PI * r * r ) / ( 2.0 * r ) );
+
+	return r;
+} // GetStreak
+
+//===================================================================================
+int BlobExtractor::FindRoot( int i )
+{
+	while ( m_Runs[i].m_Parent != i )
+	{
+		// path halving
+		m_Runs[i].m_Parent = m_Runs[m_Runs[i].m_Parent].m_Parent;
+		i = m_Runs[i].m_Parent;
+	}
+	return i;
+} // FindRoot
+
+//===================================================================================
+void BlobExtractor::Begin()
+{
+	m_Runs.clear();
+	m_PrevBegin = 0;
+	m_PrevEnd = 0;
+	m_Next = 0;
+} // Begin
+
+//===================================================================================
+void BlobExtractor::NextRow()
+{
+	m_PrevBegin = m_PrevEnd;
+	m_PrevEnd = static_cast<int>( m_Runs.size() );
+	m_Next = m_PrevBegin;
+} // NextRow
+
+//===================================================================================
+void BlobExtractor::AddRun( const int y, const int start, const int end )
+{
+	const int idx = static_cast<int>( m_Runs.size() );
+
+	Run run;
+	run.m_Y = y;
+	run.m_Start = start;
+	run.m_End = end;
+	run.m_Parent = idx;
+	run.m_Adjacent = end - start;
+	m_Runs.push_back( run );
+
+	// join the runs above that touch this one, diagonals included
+	for ( int k = m_Next; k < m_PrevEnd && m_Runs[k].m_Start <= end + 1; k++ )
+	{
+		if ( m_Runs[k].m_End < start - 1 )
+		{
+			continue;
+		}
+
+		// pixels right above each other share an edge
+		const int overlap = std::min( end, m_Runs[k].m_End ) - std::max( start, m_Runs[k].m_Start ) + 1;
+		if ( overlap > 0 )
+		{
+			m_Runs[idx].m_Adjacent += overlap;
+		}
+
+		const int a = FindRoot( idx );
+		const int b = FindRoot( k );
+		if ( a != b )
+		{
+			// the earliest run is the root
+			m_Runs[std::max( a, b )].m_Parent = std::min( a, b );
+		}
+	}
+
+	// the next run starts after end + 1, runs above that end before end can't touch it
+	while ( m_Next < m_PrevEnd && m_Runs[m_Next].m_End < end )
+	{
+		m_Next++;
+	}
+} // AddRun
+
+//===================================================================================
+void BlobExtractor::Extract(
+	const cv::Mat& bin,
+	std::vector<Blob>& blobs,
+	const cv::Point& offset )
+{
+	CV_Assert( bin.type() == CV_8UC1 );
+
+	Begin();
+
+	for ( int y = 0; y < bin.rows; y++ )
+	{
+		const uchar* row = bin.ptr<uchar>( y );
+
+		int x = 0;
+		while ( x < bin.cols )
+		{
+			while ( x < bin.cols && row[x] == 0 )
+			{
+				x++;
+			}
+
+			if ( x == bin.cols )
+			{
+				break;
+			}
+
+			const int start = x;
+			while ( x < bin.cols && row[x] != 0 )
+			{
+				x++;
+			}
+
+			AddRun( y, start, x - 1 );
+		}
+
+		NextRow();
+	}
+
+	End( blobs, offset );
+} // Extract
+
+//===================================================================================
+void BlobExtractor::Extract(
+	const BitMask& bin,
+	std::vector<Blob>& blobs,
+	const cv::Point& offset )
+{
+	Begin();
+
+	const int words = bin.GetWordsPerRow();
+
+	for ( int y = 0; y < bin.GetHeight(); y++ )
+	{
+		const uint64_t* row = bin.Row( y );
+
+		// a run may go on over several words: start is where it began, or -1
+		int start = -1;
+
+		for ( int i = 0; i < words; i++ )
+		{
+			const int base = 64 * i;
+
+			// the bits still to look at, set where the pixel differs from the run state:
+			// looking for a set bit out of a run, a clear bit in a run
+			uint64_t w = start < 0 ? row[i] : ~row[i];
+
+			while ( w != 0 )
+			{
+				const int b = BitMask::CountTrailingZeros( w );
+
+				if ( start < 0 )
+				{
+					start = base + b;
+				}
+				else
+				{
+					AddRun( y, start, base + b - 1 );
+					start = -1;
+				}
+
+				// the other state from bit b on
+				w = ~w & ( ~static_cast<uint64_t>( 0 ) << b );
+			}
+		}
+
+		// the padding bits are 0, so a run open here ends at the width
+		if ( start >= 0 )
+		{
+			AddRun( y, start, bin.GetWidth() - 1 );
+		}
+
+		NextRow();
+	}
+
+	End( blobs, offset );
+} // Extract
+
+//===================================================================================
+void BlobExtractor::End( std::vector<Blob>& blobs, const cv::Point& offset )
+{
+	blobs.clear();
+
+	// sum up the runs of each blob. The bounding box holds min x, min y, max x, max y until the end
+	m_BlobOf.assign( m_Runs.size(), -1 );
+
+	for ( int i = 0; i < static_cast<int>( m_Runs.size() ); i++ )
+	{
+		const Run& run = m_Runs[i];
+		const int root = FindRoot( i );
+
+		if ( m_BlobOf[root] < 0 )
+		{
+			m_BlobOf[root] = static_cast<int>( blobs.size() );
+			blobs.push_back( Blob() );
+			blobs.back().m_BoundingBox = cv::Rect( run.m_Start, run.m_Y, run.m_End, run.m_Y );
+		}
+
+		Blob& blob = blobs[m_BlobOf[root]];
+		const int length = run.m_End - run.m_Start + 1;
+
+		blob.m_Area += length;
+		blob.m_SumX += 0.5 * length * ( run.m_Start + run.m_End );
+		blob.m_SumY += static_cast<double>( length ) * run.m_Y;
+
+		// sum of x * x over start..end, from the sums of squares 0..n
+		const double s1 = 0.5 * length * ( run.m_Start + run.m_End );
+		const double s2 = SumOfSquares( run.m_End ) - SumOfSquares( run.m_Start - 1 );
+
+		blob.m_SumXX += s2;
+		blob.m_SumYY += static_cast<double>( length ) * run.m_Y * run.m_Y;
+		blob.m_SumXY += s1 * run.m_Y;
+		blob.m_CrackLength -= 2 * run.m_Adjacent;
+
+		cv::Rect& box = blob.m_BoundingBox;
+		box.x = std::min( box.x, run.m_Start );
+		box.width = std::max( box.width, run.m_End );
+		box.height = std::max( box.height, run.m_Y );
+	}
+
+	for ( size_t i = 0; i < blobs.size(); i++ )
+	{
+		Blob& blob = blobs[i];
+
+		// every pixel has 4 edges, minus 2 for each shared one
+		blob.m_CrackLength += 4 * blob.m_Area;
+
+		// ( x + ox ) * ( x + ox ) = x * x + 2 * ox * x + ox * ox, and so on, before the sums move
+		blob.m_SumXX += 2.0 * offset.x * blob.m_SumX + static_cast<double>( blob.m_Area ) * offset.x * offset.x;
+		blob.m_SumYY += 2.0 * offset.y * blob.m_SumY + static_cast<double>( blob.m_Area ) * offset.y * offset.y;
+		blob.m_SumXY += offset.y * blob.m_SumX + offset.x * blob.m_SumY + static_cast<double>( blob.m_Area ) * offset.x * offset.y;
+
+		blob.m_SumX += static_cast<double>( blob.m_Area ) * offset.x;
+		blob.m_SumY += static_cast<double>( blob.m_Area ) * offset.y;
+
+		cv::Rect& box = blob.m_BoundingBox;
+		box = cv::Rect( box.x + offset.x, box.y + offset.y, box.width - box.x + 1, box.height - box.y + 1 );
+	}
+} // End
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "BitMask.h"
+
+#include <vector>
+
+//===================================================================================
+// A connected set of foreground pixels (8-connectivity), and its geometry
+//===================================================================================
+struct Blob
+{
+	Blob();
+
+	// center of mass
+	cv::Point2d GetCentroid() const
+	{
+		return cv::Point2d( m_SumX / m_Area, m_SumY / m_Area );
+	}
+
+	// central second moments: the variances of x and y, and their covariance
+	void GetCovariance( double& xx, double& yy, double& xy ) const;
+
+	// fit the blob as the trace of a disk moving along a segment (motion blur): a
+	// stadium, with the same area and the same variance across as the blob.
+	// dir: unit vector along the segment, either way. length: in pixels, 0 if round.
+	// @return the radius of the disk
+	double GetStreak( cv::Point2d& dir, double& length ) const;
+
+	// perimeter estimated from the crack length: a digital disk of radius r has
+	// 8r pixel edges on its boundary, times PI / 4 is its perimeter 2 * PI * r
+	double GetPerimeter() const
+	{
+		return m_CrackLength * 0.78539815;
+	}
+
+	int			m_Area;			// number of pixels
+	double		m_SumX;			// sum of the x of the pixels
+	double		m_SumY;			// sum of the y of the pixels
+	double		m_SumXX;		// sum of x * x
+	double		m_SumYY;		// sum of y * y
+	double		m_SumXY;		// sum of x * y
+	cv::Rect	m_BoundingBox;
+	int			m_CrackLength;	// number of pixel edges between the blob and the background
+}; // Blob
+
+//===================================================================================
+// Labels the connected components of a binary image in a single scan.
+// Each row is cut into runs of foreground pixels; a run is joined (union-find) to the
+// runs it touches in the row above, and the area, sums of coordinates and of their
+// products, bounding box and crack length are gathered per run as it's found, then
+// summed per blob.
+// No pixel is visited twice and no contour is traced. The workspace is kept between
+// calls, so once warmed up it doesn't allocate.
+//===================================================================================
+class BlobExtractor
+{
+public:
+	// find the blobs of the non-zero pixels of bin (CV_8UC1), shifted by offset.
+	// blobs is overwritten
+	void Extract(
+		const cv::Mat& bin,
+		std::vector<Blob>& blobs,
+		const cv::Point& offset = cv::Point() );
+
+	// same for the set bits of bin. Whole words of background or foreground are
+	// skipped at once, the run ends are found with CountTrailingZeros
+	void Extract(
+		const BitMask& bin,
+		std::vector<Blob>& blobs,
+		const cv::Point& offset = cv::Point() );
+
+private:
+	struct Run
+	{
+		int m_Y;
+		int m_Start;	// first x
+		int m_End;		// last x
+		int m_Parent;	// union-find
+		int m_Adjacent;	// pixel pairs sharing an edge: within the run, and with the row above
+	}; // Run
+
+	int FindRoot( int i );
+
+	// the scan shared by both images: Begin(), then per row AddRun() for each run
+	// left to right and NextRow(), then End() sums up the blobs
+	void Begin();
+
+	void AddRun( const int y, const int start, const int end );
+
+	void NextRow();
+
+	void End( std::vector<Blob>& blobs, const cv::Point& offset );
+
+	std::vector<Run>	m_Runs;
+	std::vector<int>	m_BlobOf;	// index in blobs of each root run
+
+	int	m_PrevBegin;	// runs of the row above
+	int	m_PrevEnd;
+	int	m_Next;			// first run of the row above that may touch the next run
+}; // BlobExtractor
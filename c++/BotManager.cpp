@@ -3,8 +3,12 @@
 #include "Utility.h"
 #include "../arduino/aidenbot/Configuration.h"
 
+#include "StopChannel.h"
+
+#ifdef _WIN32
 #include <conio.h> // for getch
 #include <windows.h> // for kbhit
+#endif // _WIN32
 
 #define PI							3.1415926
 #define DEG_TO_RAD					PI / 180.0f
@@ -19,6 +23,7 @@
 #define PURPLE cv::Scalar( 255, 112, 132 )
 #define MEDIUM_PURPLE cv::Scalar( 219, 112, 147 )
 #define CORNER_WIN "corners"
+#define TABLE_MARGIN 8 // px around the table searched too, beyond the 5x5 noise removal
 
 //#define DEBUG_SERIAL
 
@@ -57,14 +62,42 @@ BotManager::BotManager( char* com )
 , m_ManualPickTableCorners( false )
 , m_NumFrame( 0 )
 , m_NumConsecutiveNonPuck( 0 )
+, m_PrevPuckFound( false )
+, m_PrevBotFound( false )
 , m_CorrectMissingSteps( false )
+, m_PrevCaptureTime( -1.0 )
+, m_PrevPuckTime( -1.0 )
+, m_LineTime( 0.0 )
+, m_ExposureTime( 0.0 )
+, m_Headless( false )
+, m_PyramidLevel( 0 )
 {
 	m_FpsCalculator.SetBufferSize( 10 );
+
+	// the robot's acceleration limits: (steps/s^2)/1000 to mm/ms^2
+	m_LatencyEstimator.SetLatency( static_cast<float>( VISION_SYSTEM_LAG ) );
+	m_LatencyEstimator.SetAccel( cv::Point2f(
+		MAX_X_ABS_ACCEL / 1000.0f / X_AXIS_STEPS_PER_UNIT,
+		MAX_Y_ABS_ACCEL / 1000.0f / Y_AXIS_STEPS_PER_UNIT ) );
 	m_pSerialPort = std::make_shared<SerialPort>( com );
+
+	m_PuckFinder.SetColorClass( &m_Segmenter, PUCK_CLASS );
+	m_BotFinder.SetColorClass( &m_Segmenter, BOT_CLASS );
+	UpdateColorClasses();
 }
 
 //=======================================================================
-void BotManager::Process(cv::Mat & input, cv::Mat & output)
+void BotManager::UpdateColorClasses()
+{
+	// the puck is red or orange
+	const cv::Vec6i puck[2] = { m_RedThresh, m_OrangeThresh };
+
+	m_Segmenter.SetClass( PUCK_CLASS, puck, 2 );
+	m_Segmenter.SetClass( BOT_CLASS, &m_BlueThresh, 1 );
+} // UpdateColorClasses
+
+//=======================================================================
+void BotManager::Process( cv::Mat & input, cv::Mat & output, const FrameInfo& info )
 {
 	// check if keyboard "h/H" is hit
 	if ( m_Debug )
@@ -73,28 +106,52 @@ void BotManager::Process(cv::Mat & input, cv::Mat & output)
 		return;
 	}
 
-	//if ( m_ShowOutPutImg )
+	// draw on a copy only when the output is shown. The copy goes into the
+	// same buffer every frame, so it is only allocated once
+	// (YUYV input is detected on as it is, it's only converted to be drawn on)
+	const bool yuyv = input.type() == CV_8UC2;
+
+	if ( m_ShowOutPutImg || !m_TableFound )
 	{
-		output = input.clone();
+		if ( yuyv )
+		{
+			cv::cvtColor( input, m_OutputImg, cv::COLOR_YUV2BGR_YUYV );
+		}
+		else
+		{
+			input.copyTo( m_OutputImg );
+		}
+		output = m_OutputImg;
+	}
+	else
+	{
+		output = input;
 	}
 
 	// find table range
 	if ( !m_TableFound )
 	{
-		FindTable( input );
+		if ( yuyv )
+		{
+			// the table is found on BGR
+			cv::Mat bgr = m_OutputImg.clone();
+			FindTable( bgr );
+		}
+		else
+		{
+			FindTable( input );
+		}
 	} // if ( !m_TableFound )
 
 	if ( m_TableFound )
 	{
-		cv::destroyWindow( CORNER_WIN );
-
 		if ( m_ShowOutPutImg )
 		{
-			// draw table boundary
-			cv::Point TopLeft( static_cast<int>( m_TableFinder.GetLeft() ), static_cast<int>( m_TableFinder.GetTop() ) );
-			cv::Point TopRight( static_cast<int>( m_TableFinder.GetRight() ), static_cast<int>( m_TableFinder.GetTop() ) );
-			cv::Point LowerLeft( static_cast<int>( m_TableFinder.GetLeft() ), static_cast<int>( m_TableFinder.GetBottom() ) );
-			cv::Point LowerRight( static_cast<int>( m_TableFinder.GetRight() ), static_cast<int>( m_TableFinder.GetBottom() ) );
+			// draw table boundary, as seen: not a rectangle if the camera is tilted
+			const cv::Point TopLeft = m_TableFinder.GetTopLeft();
+			const cv::Point TopRight = m_TableFinder.GetTopRight();
+			const cv::Point LowerLeft = m_TableFinder.GetLowerLeft();
+			const cv::Point LowerRight = m_TableFinder.GetLowerRight();
 
 			cv::line( output, TopLeft, TopRight, GREEN, 2 );
 			cv::line( output, TopLeft, LowerLeft, GREEN, 2 );
@@ -102,16 +159,22 @@ void BotManager::Process(cv::Mat & input, cv::Mat & output)
 			cv::line( output, LowerLeft, LowerRight, GREEN, 2 );
 		}
 
-		// get time stamp
-		clock_t curr = clock();
+		// the same frame handed back again (capture stalled), nothing new to see
+		if ( m_PrevCaptureTime >= 0.0 && info.m_CaptureTime <= m_PrevCaptureTime )
+		{
+			m_NumFrame++;
+			return;
+		}
 
-		unsigned int dt = static_cast<unsigned int>( ( curr - m_CurrTime ) * 1000.0f / CLOCKS_PER_SEC ); // in ms
+		// time between the capture of this frame and the previous one
+		const float dt = m_PrevCaptureTime < 0.0 ?
+			0.0f : static_cast<float>( info.m_CaptureTime - m_PrevCaptureTime ); // in ms
 
 		//debug
 		//dt = 50; // ms, 20 FPS, for debug purpose
 
 		// calculate FPS
-		m_FpsCalculator.AddFrameTime( dt );
+		m_FpsCalculator.AddFrame( info );
 		unsigned int fps = m_FpsCalculator.GetFPS();
 		//===========================================
 
@@ -119,13 +182,46 @@ void BotManager::Process(cv::Mat & input, cv::Mat & output)
 
 		cv::Point detectedPuckPos;
 
-		// convert RBG to HSV first
-		cv::Mat hsvImg;
-		cv::cvtColor( input, hsvImg, CV_BGR2HSV );
+		// nothing outside the table is searched: every stage works on views of
+		// m_TableRect, and the blobs are shifted back to image coordinate
+		const cv::Mat table = input( m_TableRect );
+		const cv::Mat tableMask = m_Mask( m_TableRect );
+
+		// classify puck and robot colors over the whole table in a single pass,
+		// unless they're searched in a tracking window (see DetectDisk)
+		cv::Rect win;
+		const bool fullPuck = !m_PuckTracker.GetWindow( m_TableRect, win );
+		const bool fullBot = !m_BotTracker.GetWindow( m_TableRect, win );
+
+		if ( fullPuck || fullBot )
+		{
+			const cv::Mat* img = &table;
+			const cv::Mat* mask = &tableMask;
+
+			if ( m_PyramidLevel > 0 )
+			{
+				// the disks are searched at low resolution, and refined in input
+				const double scale = 1.0 / ( 1 << m_PyramidLevel );
+				Utility::ResizeArea( table, m_CoarseImg, scale );
+
+				if ( m_CoarseMask.size() != m_CoarseImg.size() )
+				{
+					cv::resize( tableMask, m_CoarseMask, m_CoarseImg.size(), 0, 0, cv::INTER_NEAREST );
+				}
+
+				img = &m_CoarseImg;
+				mask = &m_CoarseMask;
+			}
+
+			SegmentFrame( *img, *mask, fullPuck, fullBot );
+		}
+
+		// the puck and the robot don't depend on each other until they're found
+		DetectDisks( input, info );
 
 		//1. find robot
-		cv::Point detectedBotPos( -1, -1 );
-		const bool botFound = FindRobot( detectedBotPos, hsvImg, output, dt );
+		cv::Point detectedBotPos;
+		const bool botFound = FindRobot( detectedBotPos, input, output );
 
 		// 2. find puck
 		bool bailOut = false;
@@ -135,7 +231,7 @@ void BotManager::Process(cv::Mat & input, cv::Mat & output)
 		cv::Point bouncePos;
 		cv::Point desiredBotPos;
 
-		const bool puckFound = FindPuck( detectedPuckPos, hsvImg, output, dt, fps,
+		const bool puckFound = FindPuck( detectedPuckPos, input, output, info, dt, fps,
             bailOut, prevPuckPos, predPuckPos, bouncePos, desiredBotPos );
 
         // 3. decide whether to correct missing steps
@@ -146,6 +242,11 @@ void BotManager::Process(cv::Mat & input, cv::Mat & output)
 		{
 			// send the message by com port over to Arduino
 			SendBotMessage( correctSteps );
+
+			// what the robot was told, decided on this frame: steps/s to mm/ms
+			m_LatencyEstimator.AddCommand( info.m_CaptureTime, m_Robot.GetDesiredRobotPos(), cv::Point2f(
+				m_Robot.GetDesiredRobotXSpeed() / 1000.0f / X_AXIS_STEPS_PER_UNIT,
+				m_Robot.GetDesiredRobotYSpeed() / 1000.0f / Y_AXIS_STEPS_PER_UNIT ) );
 #ifdef DEBUG_SERIAL
 			ReceiveMessage();
 #endif // DEBUG
@@ -159,7 +260,7 @@ void BotManager::Process(cv::Mat & input, cv::Mat & output)
 			}
 
 			m_Logger.LogStatus(
-				m_NumFrame, dt, fps,
+				m_NumFrame, static_cast<unsigned int>( dt + 0.5f ), fps,
 				detectedPuckPos, // img coordinate
 				bouncePos, // img coordinate
 				predPuckPos, // img coordinate
@@ -183,7 +284,7 @@ void BotManager::Process(cv::Mat & input, cv::Mat & output)
 		}
 
 		// update time stamp and puck position
-		m_CurrTime = curr;
+		m_PrevCaptureTime = info.m_CaptureTime;
 
 	} // if ( m_TableFound )
 
@@ -197,16 +298,16 @@ bool BotManager::CorrectMissingSteps( const bool botFound )
 {
     bool tmp = false;
 
-    if( m_CurrTime > 0 && botFound )
+    if( m_PrevCaptureTime >= 0.0 && botFound )
     {
         int speedThresh = 30;
         int posErr = 10;
 
-        cv::Point2f& currSpeed = m_Camera.GetCurrBotSpeed();
-        cv::Point2f& prevSpeed = m_Camera.GetPrevBotSpeed();
+        const cv::Point2f currSpeed = m_Camera.GetCurrBotSpeed();
+        const cv::Point2f prevSpeed = m_Camera.GetPrevBotSpeed();
 
-        cv::Point& currPos = m_Camera.GetCurrBotPos();
-        cv::Point& predictPos = m_Robot.GetDesiredRobotPos();
+        const cv::Point currPos = m_Camera.GetCurrBotPos();
+        const cv::Point predictPos = m_Robot.GetDesiredRobotPos();
         cv::Point posDif = predictPos - currPos;
 
         tmp =   std::abs( currSpeed.x ) < speedThresh &&
@@ -215,7 +316,7 @@ bool BotManager::CorrectMissingSteps( const bool botFound )
                 std::abs( prevSpeed.y ) < speedThresh &&
                 std::abs( posDif.x ) < posErr         &&
                 std::abs( posDif.y ) < posErr;
-    } //if( m_CurrTime > 0 )
+    } //if( m_PrevCaptureTime >= 0.0 )
 
     return m_CorrectMissingSteps && tmp;
 }//CorrectMissingSteps
@@ -223,12 +324,29 @@ bool BotManager::CorrectMissingSteps( const bool botFound )
 //=======================================================================
 void BotManager::TestMotion()
 {
-	if ( _kbhit() )
+	int key = -1;
+
+	if ( m_Headless )
+	{
+		// no console to read keys from: the key is a line typed on stdin
+		std::string cmd;
+		if ( StopChannel::PollCommand( cmd ) && cmd.size() == 1 )
+		{
+			key = cmd[0];
+		}
+	}
+#ifdef _WIN32
+	else if ( _kbhit() )
+	{
+		key = _getch();
+	}
+#endif // _WIN32
+
+	if ( key >= 0 )
 	{
         m_Robot.SetDesiredRobotYSpeed( static_cast<int>( MAX_Y_ABS_SPEED * 0.7f ) );
         m_Robot.SetDesiredRobotXSpeed( static_cast<int>( MAX_X_ABS_SPEED * 0.7f ) );
 
-		int key = _getch();
 		switch ( key )
 		{
 		case 49://"1"
@@ -272,14 +390,11 @@ void BotManager::TestMotion()
 //=======================================================================
 bool BotManager::FindRobot(
 	cv::Point& detectedBotPos,
-	const cv::Mat& hsvImg,
-	cv::Mat & output,
-	const unsigned int dt)
+	const cv::Mat& input,
+	cv::Mat & output )
 {
-	Contours contours;
-
-    bool botFound = m_BotFinder.FindDisk1Thresh(
-        contours, detectedBotPos, hsvImg, m_BlueThresh, m_Mask );
+    detectedBotPos = m_BotDetection.m_Pos;
+    bool botFound = m_BotDetection.m_Found;
 
 	if ( botFound )
 	{
@@ -307,26 +422,47 @@ bool BotManager::FindRobot(
 		{
 			m_Camera.SetCurrBotPos( botPos );
 
-            // calculate and set speed
-            m_Camera.SetPrevBotSpeed( m_Camera.GetCurrBotSpeed() );
+            // calculate and set speed: fitted on the latest sub-mm positions, at the
+            // times of the rows the robot was seen on
+            m_Camera.AddBotObservation( m_BotDetection.m_Time,
+                m_TableFinder.ImgToTableCoordinate( m_BotDetection.m_SubPixPos ) );
 
-            cv::Point posDif = m_Camera.GetCurrBotPos() - m_Camera.GetPrevBotPos();
-            const cv::Point2f tmp = static_cast<cv::Point2f>( posDif * 100 );
-            m_Camera.SetCurrBotSpeed( tmp / static_cast<int>( dt ) ); // speed in dm/ms (we use this units to not overflow the variable)
+            // the previous position is only a move away if the robot was seen on the last frame
+            const cv::Point posDif = m_PrevBotFound ?
+                m_Camera.GetCurrBotPos() - m_Camera.GetPrevBotPos() : cv::Point();
 
             m_Camera.SetPrevBotPos( botPos );
+
+            // where the commands show up, against where they were sent
+            m_LatencyEstimator.AddPosition( m_BotDetection.m_Time, botPos );
+            m_Camera.SetLatency( m_LatencyEstimator.GetLatency() );
+
+            // next frame: same move again, possibly bending towards the commanded position
+            cv::Point2f drift = m_Robot.GetDesiredRobotPos() - ( botPos + posDif );
+            const float maxDrift = static_cast<float>( cv::norm( posDif ) );
+            const float driftLength = static_cast<float>( cv::norm( drift ) );
+            if ( driftLength > maxDrift )
+            {
+                drift *= maxDrift / driftLength;
+            }
+
+            PredictNextPos( m_BotTracker, botPos, posDif, drift );
 		}
 	} // if( botFound )
 
+	m_BotTracker.Update( m_BotDetection.m_Tracked, botFound, m_BotDetection.m_Searched );
+	m_PrevBotFound = botFound;
+
 	return botFound;
 }// FindRobot
 
 //=======================================================================
 bool BotManager::FindPuck(
 	cv::Point& detectedPuckPos,
-	const cv::Mat& hsvImg,
+	const cv::Mat& input,
 	cv::Mat & output,
-	const unsigned int dt,
+	const FrameInfo& info,
+	const float dt,
 	const unsigned int fps,
 	bool& bailOut,
 	cv::Point& prevPuckPos,
@@ -334,10 +470,10 @@ bool BotManager::FindPuck(
 	cv::Point& bouncePos,
 	cv::Point& desiredBotPos )
 {
-	Contours contours;
+	detectedPuckPos = m_PuckDetection.m_Pos;
+	const bool puckFound = m_PuckDetection.m_Found;
 
-	const bool puckFound = m_PuckFinder.FindDisk2Thresh(
-		contours, detectedPuckPos, hsvImg, m_RedThresh, m_OrangeThresh, m_Mask );
+	m_PuckTracker.Update( m_PuckDetection.m_Tracked, puckFound, m_PuckDetection.m_Searched );
 
 	if ( puckFound )
 	{
@@ -353,21 +489,42 @@ bool BotManager::FindPuck(
 		// convert screen coordinate to table coordinate
 		const cv::Point puckPos = m_TableFinder.ImgToTableCoordinate( detectedPuckPos ); // mm, in table coordinate
 
-		m_Camera.SetCurrPuckPos( puckPos );
+		// no previous position to take the speed from: the motion blur gives it
+		const bool hasPrevPos = m_PrevPuckTime >= 0.0 && m_NumConsecutiveNonPuck <= 1;
+		const bool useBlur = !hasPrevPos && m_ExposureTime > 0.0;
+
+		if ( !hasPrevPos )
+		{
+			// a new track: the filter starts over. Before its first position is added,
+			// so the last one seen is still there to fit the first speed on
+			m_Camera.LosePuck();
+		}
+
+		m_Camera.AddPuckObservation( m_PuckDetection.m_Time,
+			m_TableFinder.ImgToTableCoordinate( m_PuckDetection.m_SubPixPos ) );
 
 		//ownGoal = m_Robot.IsOwnGoal( m_Camera );
 
-		// skip processing if 1st frame
+		// skip processing if 1st frame, unless the speed is from the motion blur
 
-		if ( /*!ownGoal &&*/ /*dt < 2000 &&*/ m_CurrTime > 0 )
+		if ( /*!ownGoal &&*/ /*dt < 2000 &&*/ m_PrevCaptureTime >= 0.0 || useBlur )
 		{
 			if ( m_NumConsecutiveNonPuck > 1 )
 			{
 				m_Camera.SetPrevPuckPos( cv::Point( 0, 0 ) ); // reset
 			}
 
+			// time between the rows the puck was seen on, rather than between the frames
+			const float puckDt = m_PrevPuckTime >= 0.0 && m_PuckDetection.m_Time > m_PrevPuckTime ?
+				static_cast<float>( m_PuckDetection.m_Time - m_PrevPuckTime ) : dt;
+
+			// the predicted times are counted from the capture time, the puck was there earlier
+			const float age = static_cast<float>( info.m_CaptureTime - m_PuckDetection.m_Time );
+
+			const cv::Point2f blurSpeed = useBlur ? GetBlurSpeed() : cv::Point2f();
+
 			// do prediction work
-            m_Camera.CamProcess( dt, m_Camera.GetCurrBotPos() /* table coord*/ );
+            m_Camera.CamProcess( puckDt, m_Camera.GetCurrBotPos() /* table coord*/, age, useBlur ? &blurSpeed : NULL );
 
 			prevPuckPos = m_Camera.GetPrevPuckPos(); // mm, table coordinate
 			prevPuckPos = m_TableFinder.TableToImgCoordinate( prevPuckPos );
@@ -399,20 +556,22 @@ bool BotManager::FindPuck(
 				// draw prediction on screen
 				Camera::PREDICT_STATUS predictStatus = m_Camera.GetPredictStatus();
 				if ( predictStatus == Camera::PREDICT_STATUS::DIRECT_IMPACT ||
-					predictStatus == Camera::PREDICT_STATUS::ONE_BOUNCE )
+					predictStatus == Camera::PREDICT_STATUS::ONE_BOUNCE ||
+					predictStatus == Camera::PREDICT_STATUS::MULTI_BOUNCE )
 				{
-					// draw bounce pos if there's one
-					if ( !isBounce )
-					{
-						// no bounce
-						cv::line( output, predPuckPos, detectedPuckPos, PURPLE, 2 );
-					}
-					else
+					// from the puck, through every bounce, to the predicted pos
+					const cv::Point* bounces = nullptr;
+					const int numBounces = m_Camera.GetBouncePoints( bounces );
+
+					cv::Point from = detectedPuckPos;
+					for ( int i = 0; i < numBounces; i++ )
 					{
-						// have one bounce
-						cv::line( output, bouncePos, detectedPuckPos, PURPLE, 2 );
-						cv::line( output, predPuckPos, bouncePos, PURPLE, 2 );
+						const cv::Point to = m_TableFinder.TableToImgCoordinate( bounces[i] );
+						cv::line( output, from, to, PURPLE, 2 );
+						from = to;
 					}
+
+					cv::line( output, from, predPuckPos, PURPLE, 2 );
 				}
 			}//if ( m_ShowOutPutImg )
 
@@ -420,7 +579,7 @@ bool BotManager::FindPuck(
 			m_Robot.NewDataStrategy( m_Camera );
 
 			// determine robot position
-            bailOut = m_Robot.RobotMoveDecision( m_Camera ); // determins m_DesiredRobotPos
+            bailOut = m_Robot.RobotMoveDecision( m_Camera, info.m_CaptureTime ); // determins m_DesiredRobotPos
 
             if( !bailOut )
             {
@@ -435,9 +594,21 @@ bool BotManager::FindPuck(
                     cv::circle( output, desiredBotPos, radius, BLUE, thickness );
                 }//if ( m_ShowOutPutImg )
             }
-		} // if ( /*dt < 2000 &&*/ m_CurrTime > 0 )
+		} // if ( /*dt < 2000 &&*/ m_PrevCaptureTime >= 0.0 )
+
+		// next frame: the same move again. A new track has no move yet: the window only
+		// gets its minimum radius, not the whole table from the reset position
+		const cv::Point puckStep = m_PrevPuckFound ? puckPos - m_Camera.GetPrevPuckPos() : cv::Point();
+		PredictNextPos( m_PuckTracker, puckPos, puckStep );
+
+		if ( m_Camera.GetPredictStatus() == Camera::PREDICT_STATUS::ERROR )
+		{
+			// noise, don't trust the position
+			m_PuckTracker.Lose();
+		}
 
 		m_Camera.SetPrevPuckPos( puckPos );
+		m_PrevPuckTime = m_PuckDetection.m_Time;
 
 		m_NumConsecutiveNonPuck = 0;
 	}
@@ -447,9 +618,177 @@ bool BotManager::FindPuck(
 		m_NumConsecutiveNonPuck++;
 	} // if( puckFound )
 
+	m_PrevPuckFound = puckFound;
+
 	return puckFound;
 }//FindPuck
 
+//=======================================================================
+void BotManager::SegmentFrame(
+	const cv::Mat& img,
+	const cv::Mat& mask,
+	const bool puck,
+	const bool bot )
+{
+	const int numStripes = static_cast<int>( m_Tasks.GetNumThreads() );
+
+	// the stripes are views, so the masks must be allocated first
+	if ( puck )
+	{
+		m_ClassMasks[PUCK_CLASS].create( img.size(), CV_8UC1 );
+	}
+
+	if ( bot )
+	{
+		m_ClassMasks[BOT_CLASS].create( img.size(), CV_8UC1 );
+	}
+
+	m_Segmenter.Prepare( img.type() );
+
+	m_Tasks.Run( [&]( const int i )
+	{
+		const cv::Range rows( img.rows * i / numStripes, img.rows * ( i + 1 ) / numStripes );
+
+		if ( puck && bot )
+		{
+			// both in a single pass
+			cv::Mat stripes[ColorSegmenter::MAX_CLASSES];
+			stripes[PUCK_CLASS] = m_ClassMasks[PUCK_CLASS].rowRange( rows );
+			stripes[BOT_CLASS] = m_ClassMasks[BOT_CLASS].rowRange( rows );
+
+			m_Segmenter.Segment( img.rowRange( rows ), mask.rowRange( rows ), stripes );
+		}
+		else
+		{
+			const int cls = puck ? PUCK_CLASS : BOT_CLASS;
+			cv::Mat stripe = m_ClassMasks[cls].rowRange( rows );
+
+			m_Segmenter.Segment( img.rowRange( rows ), mask.rowRange( rows ), cls, stripe );
+		}
+	}, numStripes );
+}// SegmentFrame
+
+//=======================================================================
+void BotManager::DetectDisks( const cv::Mat& input, const FrameInfo& info )
+{
+	// nothing is shared but m_Segmenter, which only reads once prepared
+	m_Segmenter.Prepare( input.type() );
+
+	// as if not found
+	m_PuckDetection.m_Pos = cv::Point();
+	m_BotDetection.m_Pos = cv::Point( -1, -1 );
+
+	m_Tasks.Run( [&]( const int i )
+	{
+		if ( i == PUCK_CLASS )
+		{
+			Detection& d = m_PuckDetection;
+			d.m_Found = DetectDisk( m_PuckFinder, m_PuckTracker, PUCK_CLASS, m_PuckBlob, d.m_Pos, input, d.m_Tracked, d.m_Searched );
+		}
+		else
+		{
+			Detection& d = m_BotDetection;
+			d.m_Found = DetectDisk( m_BotFinder, m_BotTracker, BOT_CLASS, m_BotBlob, d.m_Pos, input, d.m_Tracked, d.m_Searched );
+		}
+	}, 2 );
+
+	// a disk near the bottom of the frame was seen later than one near the top
+	m_PuckDetection.m_Time = m_PuckDetection.m_Found ?
+		GetRowTime( info, m_PuckBlob.GetCentroid().y, input.rows ) : info.m_CaptureTime;
+	m_BotDetection.m_Time = m_BotDetection.m_Found ?
+		GetRowTime( info, m_BotBlob.GetCentroid().y, input.rows ) : info.m_CaptureTime;
+
+	// m_Pos is truncated to the pixel
+	m_PuckDetection.m_SubPixPos = m_PuckDetection.m_Found ?
+		cv::Point2f( m_PuckBlob.GetCentroid() ) : cv::Point2f( m_PuckDetection.m_Pos );
+	m_BotDetection.m_SubPixPos = m_BotDetection.m_Found ?
+		cv::Point2f( m_BotBlob.GetCentroid() ) : cv::Point2f( m_BotDetection.m_Pos );
+}// DetectDisks
+
+//=======================================================================
+bool BotManager::DetectDisk(
+	DiskFinder& finder,
+	const RoiTracker& tracker,
+	const int cls,
+	Blob& disk,
+	cv::Point& pos,
+	const cv::Mat& input,
+	bool& tracked,
+	double& searched )
+{
+	cv::Rect win;
+	tracked = tracker.GetWindow( m_TableRect, win );
+
+	if ( !tracked )
+	{
+		// classified over the whole table by Process(). At full resolution the table
+		// is the same size as the class mask, and isn't used
+		searched = 1.0;
+		return finder.FindDisk( disk, pos, m_ClassMasks[cls], input( m_TableRect ), m_Mask( m_TableRect ), m_TableRect.tl() );
+	}
+
+	// only the window is classified, at full resolution
+	cv::Mat winMask = Utility::GrowOnlyView( m_WinMasks[cls], win.size(), CV_8UC1 );
+	m_Segmenter.Segment( input( win ), m_Mask( win ), cls, winMask );
+
+	searched = static_cast<double>( win.area() ) / m_TableRect.area();
+	return finder.FindDisk( disk, pos, winMask, cv::Mat(), cv::Mat(), win.tl() );
+}// DetectDisk
+
+//=======================================================================
+cv::Point2f BotManager::GetBlurSpeed()
+{
+	cv::Point2d dir;
+	double length;
+	m_PuckBlob.GetStreak( dir, length );
+
+	// the ends of the move during the exposure
+	const cv::Point2d c = m_PuckBlob.GetCentroid();
+	const cv::Point2d half = dir * ( 0.5 * length );
+	const cv::Point2f a = m_TableFinder.ImgToTableCoordinate( cv::Point2f( c - half ) );
+	const cv::Point2f b = m_TableFinder.ImgToTableCoordinate( cv::Point2f( c + half ) );
+
+	cv::Point2f speed = ( b - a ) * 100.0f / static_cast<float>( m_ExposureTime ); // 100 x mm/ms, as m_CurrPuckSpeed
+
+	// speed Y is negative when the puck is moving to the robot
+	return speed.y > 0.0f ? -speed : speed;
+}// GetBlurSpeed
+
+//=======================================================================
+void BotManager::PredictNextPos(
+	RoiTracker& tracker,
+	const cv::Point& pos,
+	const cv::Point& step,
+	const cv::Point& drift )
+{
+	const cv::Point imgPos = m_TableFinder.TableToImgCoordinate( pos );
+	const cv::Point imgNext = m_TableFinder.TableToImgCoordinate( pos + step );
+	const cv::Point imgDrift = m_TableFinder.TableToImgCoordinate( pos + step + drift );
+
+	// the faster it goes, the further off the prediction may be
+	const float uncertainty = static_cast<float>( cv::norm( imgNext - imgPos ) + cv::norm( imgDrift - imgNext ) );
+
+	tracker.Predict( imgNext, uncertainty );
+}// PredictNextPos
+
+//=======================================================================
+void BotManager::PrintStats() const
+{
+	const RoiTracker* trackers[2] = { &m_PuckTracker, &m_BotTracker };
+	const char* names[2] = { "puck", "robot" };
+
+	for ( int i = 0; i < 2; i++ )
+	{
+		std::cout << names[i] << " tracking: " << trackers[i]->GetNumHits() << " hits in "
+			<< trackers[i]->GetNumTracked() << " window searches (hit rate "
+			<< trackers[i]->GetHitRate() * 100.0 << "%), "
+			<< trackers[i]->GetNumFullSearches() << " full searches, "
+			<< trackers[i]->GetSearchedFraction() * 100.0 << "% of the pixels searched on average, "
+			<< trackers[i]->GetSmallSearchRate() * 100.0 << "% of the searches under "
+			<< RoiTracker::SMALL_SEARCH * 100.0 << "% of the pixels" << std::endl;
+	}
+}// PrintStats
+
 //=======================================================================
 void BotManager::FindTable( cv::Mat & input )
 {
@@ -458,27 +797,42 @@ void BotManager::FindTable( cv::Mat & input )
 	cv::Point LowerLeft;
 	cv::Point LowerRight;
 
-	cv::imshow( CORNER_WIN, input );
-	cv::setMouseCallback( CORNER_WIN, OnMouse, &m_Corners );
+	// let the user pick the 4 corners, unless they were given by SetTableCorners()
+	const bool pickCorners = m_Corners.size() < 4;
+
+	if ( pickCorners && m_Headless )
+	{
+		// no screen to pick them on, and nothing can be found without them
+		std::cout << "headless: table corners must be given" << std::endl;
+		StopChannel::RequestStop();
+		return;
+	}
 
-	// user-picked 4 corners
-	while ( m_Corners.size() < 4 )
+	if ( pickCorners )
 	{
-		size_t m = m_Corners.size();
-		if ( m > 0 )
+		cv::imshow( CORNER_WIN, input );
+		cv::setMouseCallback( CORNER_WIN, OnMouse, &m_Corners );
+
+		// user-picked 4 corners
+		while ( m_Corners.size() < 4 )
 		{
-			cv::circle( input, m_Corners[m - 1], 3, GREEN, 2 );
+			size_t m = m_Corners.size();
+			if ( m > 0 )
+			{
+				cv::circle( input, m_Corners[m - 1], 3, GREEN, 2 );
+			}
+
+			cv::imshow( CORNER_WIN, input );
+			cv::waitKey( 10 );
 		}
 
+		// last point
+		cv::circle( input, m_Corners[3], 3, GREEN, 2 );
+
 		cv::imshow( CORNER_WIN, input );
 		cv::waitKey( 10 );
 	}
 
-	// last point
-	cv::circle( input, m_Corners[3], 3, GREEN, 2 );
-
-	cv::imshow( CORNER_WIN, input );
-	cv::waitKey( 10 );
 	// order the 4 corners
 	OrderCorners();
 
@@ -672,6 +1026,9 @@ void BotManager::FindTable( cv::Mat & input )
 		m_TableFinder.AvgCorners();
 	} // if ( !m_ManualPickTableCorners )
 
+	// table coordinate of every pixel, and back
+	m_TableFinder.BuildLut( input.size() );
+
 	  // construct mask based on table 4 corners
 	std::vector< cv::Point > tmpContour;
 	tmpContour.push_back( TopRight );
@@ -683,21 +1040,36 @@ void BotManager::FindTable( cv::Mat & input )
 	tableContour.push_back( tmpContour );
 	m_Mask = cv::Mat::zeros( input.size(), CV_8UC1 );
 	drawContours( m_Mask, tableContour, 0, 255/*color*/, cv::FILLED );
+	m_CoarseMask.release(); // down-sampled again on the next frame
+
+	// the part of the frame that is searched
+	m_TableRect = cv::boundingRect( tmpContour );
+	m_TableRect.x -= TABLE_MARGIN;
+	m_TableRect.y -= TABLE_MARGIN;
+	m_TableRect.width += 2 * TABLE_MARGIN;
+	m_TableRect.height += 2 * TABLE_MARGIN;
+
+	// whole pixel pairs, for YUYV
+	m_TableRect.width += m_TableRect.x & 1;
+	m_TableRect.x &= ~1;
+	m_TableRect.width = ( m_TableRect.width + 1 ) & ~1;
+
+	m_TableRect &= cv::Rect( 0, 0, input.cols & ~1, input.rows );
 
 	if ( m_ShowDebugImg )
 	{
 		cv::imshow( "Mask:", m_Mask );
 	} // DEBUG
 
-	  // Log table corners
-	cv::Point tl( static_cast<int>( m_TableFinder.GetLeft() ), static_cast<int>( m_TableFinder.GetTop() ) );
-	cv::Point tr( static_cast<int>( m_TableFinder.GetRight() ), static_cast<int>( m_TableFinder.GetTop() ) );
-	cv::Point ll( static_cast<int>( m_TableFinder.GetLeft() ), static_cast<int>( m_TableFinder.GetBottom() ) );
-	cv::Point lr( static_cast<int>( m_TableFinder.GetRight() ), static_cast<int>( m_TableFinder.GetBottom() ) );
-
+	  // Log table corners, as seen: the homography's, not the averaged rectangle
 	if ( m_IsLog )
 	{
-		m_Logger.WriteTableCorners( tl, tr, ll, lr );
+		m_Logger.WriteTableCorners( TopLeft, TopRight, LowerLeft, LowerRight );
+	}
+
+	if ( pickCorners )
+	{
+		cv::destroyWindow( CORNER_WIN );
 	}
 
 	m_TableFound = true;
@@ -909,6 +1281,23 @@ void BotManager::SetManualPickTableCorners( const bool ok )
 	m_ManualPickTableCorners = ok;
 } // SetManualPickTableCorners
 
+//=======================================================================
+void BotManager::SetTableCorners(
+	const cv::Point& ul,
+	const cv::Point& ur,
+	const cv::Point& ll,
+	const cv::Point& lr )
+{
+	m_Corners.clear();
+	m_Corners.push_back( ul );
+	m_Corners.push_back( ur );
+	m_Corners.push_back( ll );
+	m_Corners.push_back( lr );
+
+	// found again on the next frame
+	m_TableFound = false;
+} // SetTableCorners
+
 //=======================================================================
 void BotManager::SetShowOutPutImg( const bool ok )
 {
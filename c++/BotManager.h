@@ -14,9 +14,12 @@
 #include "Camera.h"
 #include "Robot.h"
 #include "DiskFinder.h"
+#include "RoiTracker.h"
+#include "TaskPool.h"
 #include "SerialPort.h"
 #include "FPSCalculator.h"
 #include "Logger.h"
+#include "LatencyEstimator.h"
 
 class BotManager : public FrameProcessor
 {
@@ -24,7 +27,13 @@ public:
 	BotManager( char* com );
 	~BotManager() {}
 
-	void Process(cv::Mat & input, cv::Mat & output) override;
+	void Process( cv::Mat & input, cv::Mat & output, const FrameInfo& info ) override;
+
+	// the colors are classified on YUYV directly (see ColorSegmenter)
+	bool AcceptsYuyv() const override
+	{
+		return true;
+	}
 
 	static void OnMouse(int event, int x, int y, int f, void* data);
 
@@ -44,6 +53,20 @@ public:
 
 	void SetShowOutPutImg( const bool ok );
 
+	// no screen: never open a window. The table corners must be given by SetTableCorners()
+	void SetHeadless( const bool ok )
+	{
+		m_Headless = ok;
+	}
+
+	// give the 4 table corners (image coordinate) instead of having the user pick them,
+	// e.g. when there's no screen. They're refined like picked ones, unless manual pick is on
+	void SetTableCorners(
+		const cv::Point& ul,
+		const cv::Point& ur,
+		const cv::Point& ll,
+		const cv::Point& lr );
+
 	bool IsSerialConnected()
 	{
 		return m_pSerialPort->IsConnected();
@@ -52,16 +75,32 @@ public:
 	void SetRedThreshold( const cv::Vec6i& red )
 	{
 		m_RedThresh = red;
+		UpdateColorClasses();
 	}
 
 	void SetOrangeThreshold( const cv::Vec6i& orange )
 	{
 		m_OrangeThresh = orange;
+		UpdateColorClasses();
 	}
 
 	void SetBlueThreshold( const cv::Vec6i& blue )
 	{
 		m_BlueThresh = blue;
+		UpdateColorClasses();
+	}
+
+	// SCALAR: segment colors without SIMD, e.g. to verify the SIMD kernel.
+	// LUT: look the colors up in a table, see ColorClassLut
+	void SetColorKernel( const ColorSegmenter::KERNEL k )
+	{
+		m_Segmenter.SetKernel( k );
+	}
+
+	// bits per channel of the LUT kernel's table. 8: exact
+	void SetColorLutBits( const int bits )
+	{
+		m_Segmenter.SetLutBits( bits );
 	}
 
 	void SetIsLog( const bool isLog )
@@ -89,6 +128,13 @@ public:
 		m_BotFinder.SetAreaHigh( high );
 	}
 
+	// detect the disks on the image down-sampled by 1/2^level, then refine them in small
+	// full resolution windows. 0: detect at full resolution
+	void SetPyramidLevel( const unsigned int level )
+	{
+		m_PyramidLevel = level;
+	}
+
 	void SetCorrectMissingSteps( const bool ok )
 	{
 		m_CorrectMissingSteps = ok;
@@ -96,8 +142,77 @@ public:
 
     bool CorrectMissingSteps( const bool botFound );
 
+	// search the puck and the robot in a window around their predicted position,
+	// rather than over the whole table (see RoiTracker)
+	void SetTracking( const bool ok )
+	{
+		m_PuckTracker.SetEnabled( ok );
+		m_BotTracker.SetEnabled( ok );
+	}
+
+	// threads detecting the puck and the robot: they're searched at the same time, and
+	// the full frame color segmentation is split into a stripe of rows per thread.
+	// 1: everything on the calling thread
+	void SetNumThreads( const unsigned int n )
+	{
+		m_Tasks.Start( n );
+	}
+
+	// rolling shutter: time to read out one row of the image, in ms. The puck and the
+	// robot are timed by the row of their center. 0: global shutter
+	void SetLineTime( const double ms )
+	{
+		m_LineTime = ms;
+	}
+
+	// exposure time of the camera, in ms. A fast puck leaves a streak as long as its move
+	// during the exposure: it's then found as a streak, and the first time it's seen its
+	// speed comes from it, rather than waiting for the next frame. 0: off
+	void SetExposureTime( const double ms )
+	{
+		m_ExposureTime = ms;
+		m_PuckFinder.SetStreaks( ms > 0.0 );
+	}
+
+	// print the tracking window hit rates
+	void PrintStats() const;
+
 private:
 
+	// color classes of m_Segmenter
+	enum COLOR_CLASS { PUCK_CLASS = 0, BOT_CLASS };
+
+	// what DetectDisk found
+	struct Detection
+	{
+		bool		m_Found;
+		cv::Point	m_Pos;		// image coordinate
+		cv::Point2f	m_SubPixPos;// image coordinate, the center of the blob
+		bool		m_Tracked;	// searched in the tracking window
+		double		m_Searched;	// fraction of the table searched
+		double		m_Time;		// when the row of its center was read out, ms (see FrameInfo)
+	};
+
+	// give the thresholds to m_Segmenter
+	void UpdateColorClasses();
+
+	// classify the colors of the puck and / or the robot over img into m_ClassMasks,
+	// a stripe of rows per thread
+	void SegmentFrame(
+		const cv::Mat& img,
+		const cv::Mat& mask,
+		const bool puck,
+		const bool bot );
+
+	// detect the puck and the robot at the same time, into m_PuckDetection and m_BotDetection
+	void DetectDisks( const cv::Mat& input, const FrameInfo& info );
+
+	// when row y of the frame was read out: the last row right before the capture time
+	double GetRowTime( const FrameInfo& info, const double y, const int rows ) const
+	{
+		return info.m_CaptureTime - ( rows - 1 - y ) * m_LineTime;
+	}
+
 	// wrapper function to find table corners
 	void FindTable( cv::Mat & input );
 
@@ -113,19 +228,46 @@ private:
 	// use the user-picked band to zero out the result of Canny
 	void MaskCanny(cv::Mat & img);
 
+	// search a disk in its tracking window, or over the whole table
+	// tracked: whether it was searched in the window
+	// searched: fraction of the table searched
+	bool DetectDisk(
+		DiskFinder& finder,
+		const RoiTracker& tracker,
+		const int cls,
+		Blob& disk,
+		cv::Point& pos,
+		const cv::Mat& input,
+		bool& tracked,
+		double& searched );
+
+	// speed of the puck from its motion blur streak in m_PuckBlob, table coordinate, in
+	// 100 x mm/ms like Camera's puck speed.
+	// The streak could go either way, it's taken towards the robot: the move that matters
+	cv::Point2f GetBlurSpeed();
+
+	// tell tracker where to look in the next frame
+	// pos: current position, step: move expected until the next frame,
+	// drift: how much further it may move. table coordinate, mm
+	void PredictNextPos(
+		RoiTracker& tracker,
+		const cv::Point& pos,
+		const cv::Point& step,
+		const cv::Point& drift = cv::Point() );
+
 	// find robot pos
 	bool FindRobot(
 		cv::Point& detectedBotPos,
-		const cv::Mat& hsvImg,
-		cv::Mat & output,
-		const unsigned int dt );
+		const cv::Mat& input,
+		cv::Mat & output );
 
 	// find puck
 	bool FindPuck(
 		cv::Point& detectedPuckPos,
-		const cv::Mat& hsvImg,
+		const cv::Mat& input,
 		cv::Mat & output,
-		const unsigned int dt,
+		const FrameInfo& info,
+		const float dt,
 		const unsigned int fps,
 		bool& bailOut,
 		cv::Point& prevPuckPos,
@@ -157,13 +299,29 @@ private:
 	cv::Point m_i_lr;
 
     cv::Mat			m_Mask;     // mask represents table area
-
-	clock_t			m_CurrTime;
+	cv::Rect		m_TableRect;	// bounding rectangle of m_Mask + a margin, the only part of the frame searched
+
+	// per-frame workspace, allocated once per resolution and reused
+	cv::Mat			m_OutputImg;	// input + overlays
+	cv::Mat			m_ClassMasks[ColorSegmenter::MAX_CLASSES]; // pixels of puck and robot color, down-sampled if m_PyramidLevel > 0
+	cv::Mat			m_CoarseImg;	// down-sampled input
+	cv::Mat			m_CoarseMask;	// down-sampled m_Mask
+	cv::Mat			m_WinMasks[ColorSegmenter::MAX_CLASSES]; // class masks of the tracking windows
+	Blob			m_PuckBlob;		// detected puck
+	Blob			m_BotBlob;		// detected robot
+	Detection		m_PuckDetection;
+	Detection		m_BotDetection;
+
+	double			m_PrevCaptureTime; // ms, capture time of the previous frame. negative: no previous frame
+	double			m_PrevPuckTime;	// ms, Detection::m_Time of the previous puck position. negative: none
+	double			m_LineTime;		// ms, rolling shutter row readout time
+	double			m_ExposureTime;	// ms, for the motion blur speed. 0: not used
 	Camera			m_Camera;
 	Robot			m_Robot;
 	std::shared_ptr<SerialPort>		m_pSerialPort;
 	bool			m_ShowDebugImg;
 	bool			m_ShowOutPutImg;
+	bool			m_Headless;
 	bool			m_ManualPickTableCorners;
 	long			m_NumFrame;
 	cv::Vec6i		m_RedThresh; // for puck
@@ -171,9 +329,17 @@ private:
 	cv::Vec6i		m_BlueThresh; // for robot
 	bool			m_IsLog;
 	unsigned int	m_NumConsecutiveNonPuck; // number of consecutive frames that no puck is detected
+	bool			m_PrevPuckFound; // the puck was found on the previous frame
+	bool			m_PrevBotFound;	// the robot was found on the previous frame
+	ColorSegmenter	m_Segmenter;	// puck and robot colors, in one pass
 	DiskFinder		m_PuckFinder;
 	DiskFinder		m_BotFinder;
+	RoiTracker		m_PuckTracker;
+	RoiTracker		m_BotTracker;
+	TaskPool		m_Tasks;		// detection threads
 	FPSCalculator	m_FpsCalculator;
+	LatencyEstimator m_LatencyEstimator; // end to end latency, for m_Camera
 	Logger			m_Logger;
 	bool			m_CorrectMissingSteps;
+	unsigned int	m_PyramidLevel;	// detect at 1/2^level resolution, refine at full
 };
\ No newline at end of file
@@ -1,6 +1,16 @@
 #include "Camera.h"
 #include "../arduino/aidenbot/Configuration.h"
 #include <iostream>
+#include <algorithm>
+
+#define BLUR_SPEED_STD	0.5f	// mm/ms, of the speed from the motion blur streak
+#define NEW_SPEED_STD	5.0f	// mm/ms, of a puck seen the first time: as good as unknown
+#define PUCK_FIT_SAMPLES	6		// positions the first speed of a track is fitted on
+#define BOT_FIT_SAMPLES		8		// positions the robot's speed is fitted on
+#define FIT_SPAN			100.0	// ms, nor older than this
+#define FIT_TAU				40.0f	// ms, weight of the older positions
+#define RESTITUTION		0.83f	// speed kept at a side wall bounce (20% longer after it)
+#define DRAG			0.0f	// 1/ms, speed lost per mm travelled: none, the table is air cushioned
 
 //=========================================================
 Camera::Camera()
@@ -11,24 +21,81 @@ Camera::Camera()
     , m_PredictTimeDefence( 0 )
     , m_PredictTimeAtBounce( 0 )
     , m_PredictTimeAttack( 0 )
-{}
+    , m_PredictStd( 0.0f )
+    , m_NumBouncePoints( 0 )
+    , m_Latency( static_cast<float>( VISION_SYSTEM_LAG ) )
+{
+	// the puck's center bounces off the side walls a radius before them
+	m_PuckFilter.SetWalls( PUCK_SIZE, TABLE_WIDTH - PUCK_SIZE );
+
+	m_Trajectory.SetWalls( PUCK_SIZE, TABLE_WIDTH - PUCK_SIZE );
+	m_Trajectory.SetRestitution( RESTITUTION );
+	m_Trajectory.SetFriction( DRAG );
+
+	m_PuckHistory.SetWindow( PUCK_FIT_SAMPLES, FIT_SPAN );
+	m_PuckHistory.SetWeightTau( FIT_TAU );
+	m_BotHistory.SetWindow( BOT_FIT_SAMPLES, FIT_SPAN );
+	m_BotHistory.SetWeightTau( FIT_TAU );
+}
 
 //=========================================================
 Camera::~Camera()
 {}
 
 //=========================================================
-void Camera::CamProcess( int dt /*ms*/, const cv::Point& botPos/* table coord*/ )
+void Camera::CamProcess(
+	float dt /*ms*/,
+	const cv::Point& botPos/* table coord*/,
+	const float age /*ms*/,
+	const cv::Point2f* blurSpeed )
 {
-	// Speed calculation on each axis
-	cv::Point posDif = m_CurrPuckPos - m_PrevPuckPos;
+	// sub-mm if it was added as an observation
+	const cv::Point2f measPos = m_PuckHistory.GetSize() > 0 ?
+		m_PuckHistory.GetPos( 0 ) : cv::Point2f( m_CurrPuckPos );
 
 	m_PrevPuckSpeed = m_CurrPuckSpeed; // update old speed
-	const cv::Point2f tmp = static_cast<cv::Point2f>( posDif * 100 );
-	m_CurrPuckSpeed = tmp / dt; // speed in dm/ms (we use this units to not overflow the variable)
+
+	if ( blurSpeed != NULL )
+	{
+		// no history: the speed of this frame alone
+		m_PuckFilter.Reset( measPos, *blurSpeed / 100.0f, BLUR_SPEED_STD );
+	}
+	else if ( !m_PuckFilter.IsInitialized() )
+	{
+		// the first move: fitted on the positions of this track so far, if any
+		cv::Point2f pos, speed;
+		if ( !m_PuckHistory.Fit( pos, speed ) )
+		{
+			speed = cv::Point2f();
+		}
+
+		m_PuckFilter.Reset( measPos, speed, NEW_SPEED_STD );
+	}
+	else
+	{
+		// the state of the previous detection moved to this one, blended with it
+		m_PuckFilter.Predict( dt );
+		m_PuckFilter.Correct( measPos );
+	}
+
+	// the speed before a bounce or a hit isn't this one's
+	if ( m_PuckFilter.HasBounced() || m_PuckFilter.HasManeuvered() )
+	{
+		m_PuckHistory.Split();
+	}
+
+	// speed in dm/ms (we use this units to not overflow the variable).
+	// Already smoothed by the filter, and it reacts to a hit at once
+	m_CurrPuckSpeed = m_PuckFilter.GetSpeed() * 100.0f;
+	m_AverageSpeed = m_CurrPuckSpeed;
 
 	m_BouncePos.x = -1;
 	m_BouncePos.y = -1;
+	m_NumBouncePoints = 0;
+
+	// no attack unless the puck is predicted to cross the attack line below, on any path
+	m_PredictXAttack = -1;
+	m_PredictTimeAttack = -1;
 
 	// Noise detection, if there are a big speeds this should be noise
 	if ( m_CurrPuckSpeed.x < -1000 ||
@@ -40,20 +107,11 @@ void Camera::CamProcess( int dt /*ms*/, const cv::Point& botPos/* table coord*/
 		m_PredictStatus = ERROR;
 		m_PrevPredictPos.x = -1;
 
-		return;
-	}
-
-	cv::Point2f speedDif( std::abs( m_CurrPuckSpeed.x - m_PrevPuckSpeed.x ), std::abs( m_CurrPuckSpeed.y - m_PrevPuckSpeed.y ) );
-
-	float SPEED_THRESH = 50.0f;
+		// don't keep a state built on it, nor the position: the next fit starts after it
+		m_PuckFilter.Clear();
+		m_PuckHistory.Restart();
 
-	if ( speedDif.x < SPEED_THRESH || speedDif.y < SPEED_THRESH )
-	{
-		m_AverageSpeed = m_CurrPuckSpeed * 0.7f + m_PrevPuckSpeed * 0.3f;
-	}
-	else
-	{
-		m_AverageSpeed = m_CurrPuckSpeed;
+		return;
 	}
 
     if( IsOwnGoal( botPos ) )
@@ -62,111 +120,85 @@ void Camera::CamProcess( int dt /*ms*/, const cv::Point& botPos/* table coord*/
         return;
     }
 
-	m_PredictXAttack = -1;
-
 	// It's time to predict...
 	// Based on current & previous position we predict the future
 	// Posible impact? speed Y is negative when the puck is moving to the robot
 	if ( m_AverageSpeed.y < FAST_IN_Y_SPEED )
 	{
 		// Puck is comming...
-		// We need to predict the puck position when it reaches our goal Y position = defense_position
-		// slope formula: m = (y2-y1)/(x2-x1)
-		float slope = posDif.x == 0 ?   // To avoid division by 0
-			9999999.0f : static_cast<float>( posDif.y ) / static_cast<float>( posDif.x );
-
-		// Prediction of the new x position at defense position: x2 = (y2-y1)/m + x1
-		m_CurrPredictPos.y = ROBOT_DEFENSE_POSITION_DEFAULT + PUCK_SIZE;
-		m_CurrPredictPos.x = static_cast<int>( static_cast<float>( m_CurrPredictPos.y - m_CurrPuckPos.y ) / slope ) + m_CurrPuckPos.x;
+		// We need to predict the puck position when it reaches our goal Y position = defense_position.
+		// The walls are unfolded, so any number of bounces costs the same as none
+		m_Trajectory.Solve( m_PuckFilter.GetPos(), m_PuckFilter.GetSpeed() );
 
-		// Prediction of the new x position at attack position
-		m_PredictXAttack = static_cast<int>( static_cast<float>( ROBOT_DEFENSE_ATTACK_POSITION_DEFAULT + PUCK_SIZE - m_CurrPuckPos.y ) / slope ) + m_CurrPuckPos.x;
+		const float defenceY = static_cast<float>( ROBOT_DEFENSE_POSITION_DEFAULT + PUCK_SIZE );
 
-		// puck has a bounce with side wall?
-		const bool hasBounce = HasBounce( m_CurrPredictPos.x );
-		if ( hasBounce )
+		Trajectory::Crossing defence;
+		if ( !m_Trajectory.CrossY( defenceY, defence ) )
 		{
-			m_PredictStatus = ONE_BOUNCE;
+			// it stops before
+			m_PrevPredictPos.x = -1;
+			m_CurrNumPredictBounce = 0;
+			m_PredictStatus = NO_RISK;
+		}
+		else
+		{
+			m_CurrPredictPos = cv::Point( defence.m_Pos );
+			m_CurrNumPredictBounce = defence.m_NumBounces;
 
-			// We start a new prediction
+			// how far off the prediction may be, a bounce mirrors it but keeps its size
+			m_PredictStd = m_PuckFilter.GetStdX( defence.m_Time );
 
-			// Wich side?
-			m_BouncePos.x = m_CurrPredictPos.x < PUCK_SIZE ?
-				PUCK_SIZE /*Left side*/ : TABLE_WIDTH - PUCK_SIZE /*Right side*/;
+			// Prediction of the new x position at attack position
+			Trajectory::Crossing attack;
+			if ( m_Trajectory.CrossY( static_cast<float>( ROBOT_DEFENSE_ATTACK_POSITION_DEFAULT + PUCK_SIZE ), attack ) )
+			{
+				m_PredictXAttack = static_cast<int>( attack.m_Pos.x );
+				m_PredictTimeAttack = static_cast<int>( attack.m_Time - age - m_Latency ); // in ms
+			}
 
-			m_BouncePos.y = static_cast<int>( static_cast<float>( m_BouncePos.x - m_CurrPuckPos.x ) * slope ) + m_CurrPuckPos.y;
+			// every bounce on the way
+			cv::Point2f points[MAX_PREDICT_BOUNCES];
+			float times[MAX_PREDICT_BOUNCES];
+			m_Trajectory.GetBounces( defenceY, points, times, MAX_PREDICT_BOUNCES );
 
-            m_PredictTimeAtBounce = static_cast<int>( static_cast<float>( m_BouncePos.y - m_CurrPuckPos.y ) * 100.0f / m_CurrPuckSpeed.y ); // time until bouce
+			m_NumBouncePoints = std::min( defence.m_NumBounces, static_cast<int>( MAX_PREDICT_BOUNCES ) );
+			for ( int i = 0; i < m_NumBouncePoints; i++ )
+			{
+				m_BouncePoints[i] = cv::Point( points[i] );
+			}
 
-            // bounce prediction => slope change  with the bounce, we only need to change the sign, easy!!
-			slope = -slope;
+			if ( m_NumBouncePoints > 0 )
+			{
+				m_BouncePos = m_BouncePoints[0];
+				m_PredictTimeAtBounce = static_cast<int>( times[0] - age ); // time until bouce
+			}
 
-			m_CurrPredictPos.y = ROBOT_DEFENSE_POSITION_DEFAULT + PUCK_SIZE;
-			m_CurrPredictPos.x = static_cast<int>( static_cast<float>( m_CurrPredictPos.y - m_BouncePos.y ) / slope ) + m_BouncePos.x;
+			m_PredictStatus =
+				defence.m_NumBounces == 0 ? DIRECT_IMPACT :
+				defence.m_NumBounces == 1 ? ONE_BOUNCE : MULTI_BOUNCE;
 
-			const bool hasAnotherBounce = HasBounce( m_CurrPredictPos.x );
-			if ( hasAnotherBounce ) // New bounce with side wall?
+			// If the puck was just hit towards a wall, its speed is from two positions only
+			if ( defence.m_NumBounces > 0 && m_PuckFilter.HasManeuvered() )
 			{
-				m_CurrNumPredictBounce = 2;
-				// We do nothing then... with two bounces there are small risk of goal...
+				// We dont make a new prediction...
 				m_PrevPredictPos.x = -1;
-				m_PredictStatus = NO_RISK; // no risk
 			}
 			else
 			{
-				m_CurrNumPredictBounce = 1;
-
-				// only one side bounce...
-				// If the puckSpeedY has changed a lot this mean that the puck has touched one side
-				if ( std::abs( m_CurrPuckSpeed.y - m_PrevPuckSpeed.y ) > 50 )
-				{
-					// We dont make a new prediction...
-					m_PrevPredictPos.x = -1;
-				}
-				else
-				{
-					// average of the results (some noise filtering)
-					if ( m_PrevPredictPos.x != -1 )
-					{
-						m_CurrPredictPos.x = static_cast<int>( ( m_PrevPredictPos.x + m_CurrPredictPos.x ) * 0.5f );
-					}
-
-					m_PrevPredictPos.x = m_CurrPredictPos.x;
-
-					// We introduce a factor (120 instead of 100) to model the bounce (20% loss in speed)(to improcve...)
-					m_PredictTimeDefence = m_PredictTimeAtBounce + static_cast<int>( ( m_CurrPredictPos.y - m_BouncePos.y ) * 120.0f / m_CurrPuckSpeed.y ); // in ms
-					m_PredictTimeDefence -= VISION_SYSTEM_LAG;
-				}
-			}
-		} // puck has a bounce with side wall
-		else
-		{
-			// No bounce, direct impact
-			m_PredictStatus = DIRECT_IMPACT;
-			m_CurrNumPredictBounce = 0;
-
-			// ==1 or 2 means the first direct impact trajectory after a bounce.
-			// We dont predict, because the previous pos is before bounce, so the calculated
-			// offset & speed is not correct.
-			if ( m_PrevNumPredictBounce == 0 )
-			{
-				// average of the results (some noise filtering)
-				if ( m_PrevPredictPos.x > 0 )
-				{
-					m_CurrPredictPos.x = static_cast<int>( ( m_PrevPredictPos.x + m_CurrPredictPos.x ) * 0.5f );
-				}
-
+				// (the noise is filtered by m_PuckFilter; the first direct impact trajectory
+				// after a bounce is predicted too, the filter reflects the move at the wall)
 				m_PrevPredictPos.x = m_CurrPredictPos.x;
 
-				m_PredictTimeDefence = static_cast<int>( ( ROBOT_DEFENSE_POSITION_DEFAULT + PUCK_SIZE - m_CurrPuckPos.y ) * 100.0f / m_CurrPuckSpeed.y ) - VISION_SYSTEM_LAG; // in ms
-				m_PredictTimeAttack = static_cast<int>( ( ROBOT_DEFENSE_ATTACK_POSITION_DEFAULT + PUCK_SIZE - m_CurrPuckPos.y ) * 100.0f / m_CurrPuckSpeed.y ) - VISION_SYSTEM_LAG; // in ms
-			}//if ( m_PrevNumPredictBounce == 0 )
-		} // // No bounce, direct impact
+				// the bounces slow the puck down (restitution), already in the time
+				m_PredictTimeDefence = static_cast<int>( defence.m_Time - age - m_Latency ); // in ms
+			}
+		}
 	}// coming fast into our field
 	else
 	{
 		// Puck is moving slowly, or to the other side
 		m_PrevPredictPos.x = -1;
+		m_CurrNumPredictBounce = 0;
 		m_PredictStatus = NO_RISK;
 	}//if ( m_AverageSpeed.y < -50 )
 
@@ -179,18 +211,19 @@ bool Camera::IsOwnGoal(const cv::Point& botPos /* table coord*/) const
     return  m_CurrPuckPos.y < botPos.y;
 } // IsOwnGoal
 
-//=========================================================
-bool Camera::HasBounce( const int x ) const
-{
-	return x < PUCK_SIZE || x > TABLE_WIDTH - PUCK_SIZE;
-}
-
 //=========================================================
 cv::Point Camera::PredictPuckPos( int predictTime )
 {
-	predictTime += VISION_SYSTEM_LAG;
-	cv::Point tmpPos( m_AverageSpeed * predictTime / 100.0f );
-	return m_CurrPuckPos + tmpPos;
+	predictTime += static_cast<int>( m_Latency );
+
+	if ( !m_PuckFilter.IsInitialized() )
+	{
+		cv::Point tmpPos( m_AverageSpeed * predictTime / 100.0f );
+		return m_CurrPuckPos + tmpPos;
+	}
+
+	// bouncing off the side walls
+	return cv::Point( m_PuckFilter.Extrapolate( static_cast<float>( predictTime ) ) );
 } // PredictPuckYPos
 
 //=========================================================
@@ -205,6 +238,38 @@ cv::Point Camera::GetCurrPuckPos() const
     return m_CurrPuckPos;
 }
 
+//=========================================================
+void Camera::AddPuckObservation( const double time, const cv::Point2f& pos )
+{
+    m_CurrPuckPos = cv::Point( pos );
+    m_PuckHistory.Add( time, pos );
+}
+
+//=========================================================
+const PosHistory& Camera::GetPuckHistory() const
+{
+    return m_PuckHistory;
+}
+
+//=========================================================
+void Camera::AddBotObservation( const double time, const cv::Point2f& pos )
+{
+    m_BotHistory.Add( time, pos );
+
+    cv::Point2f fitPos, speed;
+    if ( m_BotHistory.Fit( fitPos, speed ) )
+    {
+        m_PrevBotSpeed = m_CurrBotSpeed;
+        m_CurrBotSpeed = speed * 100.0f; // dm/ms
+    }
+}
+
+//=========================================================
+const PosHistory& Camera::GetBotHistory() const
+{
+    return m_BotHistory;
+}
+
 //=========================================================
 void Camera::SetPrevPuckPos( const cv::Point& pos )
 {
@@ -295,6 +360,25 @@ cv::Point2f Camera::GetCurrPuckSpeed() const
     return m_CurrPuckSpeed;
 }
 
+//=========================================================
+float Camera::GetPredictStd() const
+{
+    return m_PredictStd;
+}
+
+//=========================================================
+const cv::Matx44f& Camera::GetPuckCovariance() const
+{
+    return m_PuckFilter.GetCovariance();
+}
+
+//=========================================================
+void Camera::LosePuck()
+{
+    m_PuckHistory.Split();
+    m_PuckFilter.Clear();
+}
+
 //=========================================================
 int Camera::GetPredictXAttack()
 {
@@ -313,6 +397,31 @@ cv::Point Camera::GetBouncePos() const
 	return m_BouncePos;
 }
 
+//=========================================================
+int Camera::GetBouncePoints( const cv::Point*& points ) const
+{
+	points = m_BouncePoints;
+	return m_NumBouncePoints;
+}
+
+//=========================================================
+const Trajectory& Camera::GetTrajectory() const
+{
+	return m_Trajectory;
+}
+
+//=========================================================
+void Camera::SetLatency( const float ms )
+{
+	m_Latency = ms;
+}
+
+//=========================================================
+float Camera::GetLatency() const
+{
+	return m_Latency;
+}
+
 //=========================================================
 void Camera::SetCurrBotSpeed( const cv::Point2f& s )
 {
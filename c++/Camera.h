@@ -5,6 +5,10 @@
 #include <opencv2/video.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include "PuckFilter.h"
+#include "Trajectory.h"
+#include "PosHistory.h"
+
 class Camera
 {
 public:
@@ -12,7 +16,11 @@ public:
     // 0 : No risk,
     // 1 : Puck is moving to our field directly fast, with no bounce
     // 2 : Puck is moving to our field fast, with a bounce
-    enum PREDICT_STATUS { ERROR = -1, NO_RISK, DIRECT_IMPACT, ONE_BOUNCE, OWN_GOAL };
+    // 4 : Puck is moving to our field fast, with two bounces or more (bank shot)
+    enum PREDICT_STATUS { ERROR = -1, NO_RISK, DIRECT_IMPACT, ONE_BOUNCE, OWN_GOAL, MULTI_BOUNCE };
+
+    // bounce points kept for the prediction
+    enum { MAX_PREDICT_BOUNCES = 8 };
 
 	Camera();
 	~Camera();
@@ -22,6 +30,13 @@ public:
 
 	cv::Point GetCurrPuckPos() const;
 
+	// a puck position seen at time (ms, see FrameInfo), sub-mm. Sets the current
+	// position, and is the measurement CamProcess() filters
+	void AddPuckObservation( const double time, const cv::Point2f& pos );
+
+	// the puck positions seen, split at the bounces and hits
+	const PosHistory& GetPuckHistory() const;
+
 	// Previous Puck Position
 	void SetPrevPuckPos( const cv::Point& pos );
 
@@ -32,13 +47,29 @@ public:
 
 	cv::Point GetCurrBotPos() const;
 
+	// a robot position seen at time (ms, see FrameInfo), sub-mm. Sets the current speed,
+	// fitted on the latest positions (the previous one is kept)
+	void AddBotObservation( const double time, const cv::Point2f& pos );
+
+	const PosHistory& GetBotHistory() const;
+
 	// Previous Bot Position
 	void SetPrevBotPos( const cv::Point& pos );
 
 	cv::Point GetPrevBotPos() const;
 
 	// Main function
-	void CamProcess( int dt /*ms*/, const cv::Point& botPos /*table coord*/ );
+	// dt: time between the capture of the current and the previous puck position
+	// age: how long before the frame's capture time the current puck position was seen
+	// (rolling shutter: the rows are read out one after the other). The predicted times
+	// are counted from the capture time
+	// blurSpeed: the speed from the motion blur of this frame alone (dm/ms). When given,
+	// it's used instead of the positions, e.g. the first time the puck is seen
+	void CamProcess(
+		float dt /*ms*/,
+		const cv::Point& botPos /*table coord*/,
+		const float age = 0.0f /*ms*/,
+		const cv::Point2f* blurSpeed = NULL );
 
     bool IsOwnGoal( const cv::Point& botPos ) const;
 
@@ -49,10 +80,16 @@ public:
 
     int GetPredictTimeAtBounce() const;
 
+	// ms until the puck crosses the attack line. -1: it isn't predicted to
 	int GetPredictTimeAttack() const;
 
 	cv::Point PredictPuckPos( int predictTime );
 
+	// ms from the capture of a frame to the robot moving on it (see LatencyEstimator).
+	// Taken off the predicted times, and added to PredictPuckPos()
+	void SetLatency( const float ms );
+	float GetLatency() const;
+
     PREDICT_STATUS GetPredictStatus() const;
 
 	cv::Point GetCurrPredictPos() const;
@@ -63,10 +100,29 @@ public:
 
 	cv::Point2f GetCurrPuckSpeed() const;
 
+	// std of the predicted x at the defense line (mm): how far to trust the prediction
+	float GetPredictStd() const;
+
+	// covariance of the filtered puck state x, y (mm), vx, vy (mm/ms), see PuckFilter
+	const cv::Matx44f& GetPuckCovariance() const;
+
+	// the puck was missed too long: a new track. Call it before adding its first position:
+	// the last one seen is kept to fit the first speed on, unless the fit's span drops it
+	void LosePuck();
+
+	// x where the puck crosses the attack line. -1: it isn't predicted to
 	int GetPredictXAttack();
 
 	cv::Point GetBouncePos() const;
 
+	// the bounces before the defense line, in order (table coord), the first is
+	// GetBouncePos(). At most MAX_PREDICT_BOUNCES
+	int GetBouncePoints( const cv::Point*& points ) const;
+
+	// the predicted path from the current puck state: where and when it crosses any
+	// y line, and every bounce on the way
+	const Trajectory& GetTrajectory() const;
+
     void SetCurrBotSpeed( const cv::Point2f& s );
     cv::Point2f GetCurrBotSpeed() const;
 
@@ -75,8 +131,6 @@ public:
 
 private:
 
-	bool HasBounce( const int x ) const;
-
 	/////////////////////////////
 	// Puck
 	/////////////////////////////
@@ -89,14 +143,24 @@ private:
 	cv::Point		m_CurrPredictPos;     // predicted pos at defense line, mm, table coordinate
 	cv::Point		m_PrevPredictPos;
 	cv::Point		m_BouncePos;
+	cv::Point		m_BouncePoints[MAX_PREDICT_BOUNCES];
+	int				m_NumBouncePoints;
 	int				m_PredictXAttack;     // predicted X coordinate for attack, at the attack line
 
 	//////////////
 	// puck speed
 	//////////////
-	cv::Point2f		m_CurrPuckSpeed;      // current speed. dm/ms
+	cv::Point2f		m_CurrPuckSpeed;      // current speed. dm/ms, filtered
 	cv::Point2f		m_PrevPuckSpeed;      // previous speed. dm/ms
-	cv::Point2f		m_AverageSpeed;
+	cv::Point2f		m_AverageSpeed;       // same as m_CurrPuckSpeed, the filter smooths it
+
+	//////////////
+	// puck state
+	//////////////
+	PuckFilter		m_PuckFilter;         // position and speed, from the positions over time
+	float			m_PredictStd;         // mm, std of m_CurrPredictPos.x
+	PosHistory		m_PuckHistory;        // positions seen, a new segment for a new track
+	Trajectory		m_Trajectory;         // path from the filtered state
 
 	//////////////
 	// Bounce
@@ -119,6 +183,7 @@ private:
 	//////////////
 	cv::Point2f		m_CurrBotSpeed;      // current speed. dm/ms
 	cv::Point2f		m_PrevBotSpeed;
+	PosHistory		m_BotHistory;         // positions seen, the speed is fitted on them
 
     //////////////
 	// status
@@ -129,6 +194,7 @@ private:
 	// Time
 	//////////////
 	int				m_PredictTimeDefence;
+	float			m_Latency;            // ms, end to end
     int				m_PredictTimeAtBounce;
 	int				m_PredictTimeAttack; // the estimated travel time from puck's current position to the attack line. if the time is small, defence, otherwise attack
 
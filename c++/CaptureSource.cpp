@@ -0,0 +1,147 @@
+#include "CaptureSource.h"
+
+#define FRAME_WIDTH 640
+#define FRAME_HEIGHT 360
+
+//=======================================================================
+CaptureSource::CaptureSource()
+	: m_FrameIndex( 0 )
+	, m_IsCamera( false )
+	, m_Yuyv( false )
+{}
+
+//=======================================================================
+bool CaptureSource::Open( const std::string& filename )
+{
+	Close();
+
+	m_IsCamera = false;
+	m_Yuyv = false;
+	return m_Capture.open( filename );
+}
+
+//=======================================================================
+bool CaptureSource::Open( const int id, const bool yuyv )
+{
+	Close();
+
+	m_IsCamera = true;
+	m_Yuyv = false;
+	bool ok = m_Capture.open( id );
+
+	// note the setting of resolution has to come AFTER we open it!
+	ok = ok && m_Capture.set( CV_CAP_PROP_FRAME_WIDTH, FRAME_WIDTH );
+	ok = ok && m_Capture.set( CV_CAP_PROP_FRAME_HEIGHT, FRAME_HEIGHT );
+
+	if ( ok && yuyv )
+	{
+		// not every backend can skip the conversion, BGR then
+		m_Yuyv =
+			m_Capture.set( CV_CAP_PROP_FOURCC, CV_FOURCC( 'Y', 'U', 'Y', 'V' ) ) &&
+			m_Capture.set( CV_CAP_PROP_CONVERT_RGB, 0 );
+	}
+
+	return ok;
+}
+
+//=======================================================================
+void CaptureSource::Close()
+{
+	m_Capture.release();
+	m_FrameIndex = 0;
+}
+
+//=======================================================================
+bool CaptureSource::Grab( cv::Mat& frame, FrameInfo& info )
+{
+	const bool ok = m_Capture.read( m_Frame );
+
+	info.m_CaptureTime = FrameInfo::Now();
+	info.m_SourceTime = m_Capture.get( CV_CAP_PROP_POS_MSEC );
+	info.m_Index = m_FrameIndex++;
+
+	frame = m_Frame;
+
+	if ( ok && m_Yuyv && m_Frame.type() != CV_8UC2 )
+	{
+		// some backends hand out the raw buffer as bytes
+		const cv::Size s = GetFrameSize();
+		if ( m_Frame.isContinuous() && m_Frame.total() * m_Frame.elemSize() == s.area() * 2 )
+		{
+			frame = m_Frame.reshape( 2, s.height );
+		}
+	}
+
+	return ok;
+} // Grab
+
+//=======================================================================
+cv::Size CaptureSource::GetFrameSize()
+{
+	int w = static_cast<int>( m_Capture.get( CV_CAP_PROP_FRAME_WIDTH ) );
+	int h = static_cast<int>( m_Capture.get( CV_CAP_PROP_FRAME_HEIGHT ) );
+
+	return cv::Size( w, h );
+}
+
+//=======================================================================
+long CaptureSource::GetFrameNumber()
+{
+	return static_cast<long>( m_Capture.get( CV_CAP_PROP_POS_FRAMES ) );
+}
+
+//=======================================================================
+long CaptureSource::GetTotalFrameCount()
+{
+	return static_cast<long>( m_Capture.get( CV_CAP_PROP_FRAME_COUNT ) );
+}
+
+//=======================================================================
+double CaptureSource::GetPositionMS()
+{
+	return m_Capture.get( CV_CAP_PROP_POS_MSEC );
+}
+
+//=======================================================================
+double CaptureSource::GetFrameRate()
+{
+	return m_Capture.get( CV_CAP_PROP_FPS );
+}
+
+//=======================================================================
+int CaptureSource::GetCodec( char codec[4] )
+{
+	union
+	{
+		int value;
+		char code[4];
+	} returned;
+
+	returned.value = static_cast<int>( m_Capture.get( CV_CAP_PROP_FOURCC ) );
+
+	codec[0] = returned.code[0];
+	codec[1] = returned.code[1];
+	codec[2] = returned.code[2];
+	codec[3] = returned.code[3];
+
+	return returned.value;
+} // GetCodec
+
+//=======================================================================
+bool CaptureSource::SetFrameNumber( long pos )
+{
+	//return m_Capture.set( CV_CAP_PROP_POS_FRAMES, pos );
+	return true;
+}
+
+//=======================================================================
+bool CaptureSource::SetPositionMS( double pos )
+{
+	return m_Capture.set( CV_CAP_PROP_POS_MSEC, pos );
+}
+
+//=======================================================================
+bool CaptureSource::SetRelativePosition( double pos )
+{
+	return m_Capture.set( CV_CAP_PROP_POS_AVI_RATIO, pos );
+}
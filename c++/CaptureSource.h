@@ -0,0 +1,75 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+
+#include <string>
+
+#include "FrameSource.h"
+
+//===================================================================================
+// Frames from cv::VideoCapture: a video file or a camera
+//===================================================================================
+class CaptureSource : public FrameSource
+{
+public:
+	CaptureSource();
+
+	// open a video file
+	bool Open( const std::string& filename );
+
+	// open a camera, at the default resolution
+	// yuyv: ask for its YUYV frames as they are, not converted to BGR
+	bool Open( const int id, const bool yuyv = false );
+
+	bool IsOpened() const override
+	{
+		return m_Capture.isOpened();
+	}
+
+	void Close() override;
+
+	bool Grab( cv::Mat& frame, FrameInfo& info ) override;
+
+	cv::Size GetFrameSize() override;
+
+	PIXEL_FORMAT GetPixelFormat() const override
+	{
+		return m_Yuyv ? YUYV : BGR;
+	}
+
+	// a camera has no recorded time line
+	bool HasSourceTime() const override
+	{
+		return !m_IsCamera;
+	}
+
+	// frames are read into the same buffer every time
+	bool IsZeroCopy() const override
+	{
+		return true;
+	}
+
+	long GetFrameNumber() override;
+
+	long GetTotalFrameCount() override;
+
+	double GetPositionMS() override;
+
+	double GetFrameRate() override;
+
+	int GetCodec( char codec[4] ) override;
+
+	bool SetFrameNumber( long pos ) override;
+
+	bool SetPositionMS( double pos ) override;
+
+	bool SetRelativePosition( double pos ) override;
+
+private:
+	cv::VideoCapture	m_Capture;
+	cv::Mat				m_Frame;		// last frame read
+	long				m_FrameIndex;	// index of the next frame
+	bool				m_IsCamera;
+	bool				m_Yuyv;			// camera frames left in YUYV
+}; // CaptureSource
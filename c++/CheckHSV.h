@@ -22,7 +22,7 @@ class CheckHSV : public FrameProcessor
 {
 public:
 
-    void Process( cv::Mat & input, cv::Mat & output ) override
+    void Process( cv::Mat & input, cv::Mat & output, const FrameInfo& info ) override
     {
 		output = input.clone();
         cv::cvtColor(input, input, CV_BGR2HSV );
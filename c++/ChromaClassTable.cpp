@@ -0,0 +1,54 @@
+#include "ChromaClassTable.h"
+
+//===================================================================================
+ChromaClassTable::ChromaClassTable()
+	: m_NumClasses( 0 )
+{}
+
+//===================================================================================
+void ChromaClassTable::Create( const int numClasses )
+{
+	m_NumClasses = numClasses;
+
+	Gate empty;
+	empty.m_Lo = 255;
+	empty.m_Hi = 0;
+
+	m_Gates.assign( static_cast<size_t>( 256 * 256 ) * numClasses * MAX_GATES, empty );
+} // Create
+
+//===================================================================================
+void ChromaClassTable::SetClass( const int u, const int v, const int cls, const uchar* in )
+{
+	Gate* gates = &m_Gates[( ( ( static_cast<size_t>( v ) << 8 ) | u ) * m_NumClasses + cls ) * MAX_GATES];
+
+	int n = 0;
+	int y = 0;
+	while ( y < 256 )
+	{
+		while ( y < 256 && in[y] == 0 )
+		{
+			y++;
+		}
+
+		if ( y == 256 )
+		{
+			break;
+		}
+
+		const int lo = y;
+		while ( y < 256 && in[y] != 0 )
+		{
+			y++;
+		}
+
+		if ( n < MAX_GATES )
+		{
+			gates[n].m_Lo = static_cast<uchar>( lo );
+			n++;
+		}
+
+		// more intervals than gates: the last gate spans the rest
+		gates[n - 1].m_Hi = static_cast<uchar>( y - 1 );
+	}
+} // SetClass
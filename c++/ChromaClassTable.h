@@ -0,0 +1,67 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+//===================================================================================
+// Maps a YUV pixel to the bits of its color classes (bit c: class c, see
+// ColorSegmenter) from its chroma, with the luma only as a gate.
+// For a given U, V the BGR differences, so the hue and max - min, don't depend on Y:
+// Y only moves V = max( B, G, R ) and with it S = ( max - min ) / V. So the lumas
+// of a chroma that are in a class are an interval, two for a class of two ranges.
+// Each U, V holds up to MAX_GATES luma intervals per class. Where the rounding of the
+// conversion, or a channel clipping at 0 or 255, breaks them into more, the extra ones
+// are merged into the last: about 0.2% of the pixels of a class differ, at its edges.
+// The table takes 256 x 256 x numClasses x MAX_GATES x 2 bytes.
+//===================================================================================
+class ChromaClassTable
+{
+public:
+	enum { MAX_GATES = 2 };
+
+	// lumas [m_Lo, m_Hi] of a chroma in a class. Empty: m_Lo > m_Hi
+	struct Gate
+	{
+		uchar m_Lo;
+		uchar m_Hi;
+	}; // Gate
+
+	ChromaClassTable();
+
+	// allocate the table, every chroma in no class
+	void Create( const int numClasses );
+
+	bool IsCreated() const
+	{
+		return !m_Gates.empty();
+	}
+
+	// from in[y] for y = 0..255: whether the color u, v, y is in class cls
+	void SetClass( const int u, const int v, const int cls, const uchar* in );
+
+	// the gates of chroma u, v: MAX_GATES per class
+	const Gate* GetGates( const int u, const int v ) const
+	{
+		return &m_Gates[( ( static_cast<size_t>( v ) << 8 ) | u ) * m_NumClasses * MAX_GATES];
+	}
+
+	// the classes of luma y, with the gates of its chroma
+	uchar Lookup( const Gate* gates, const uchar y ) const
+	{
+		uchar classes = 0;
+		for ( int c = 0; c < m_NumClasses; c++, gates += MAX_GATES )
+		{
+			if ( ( y >= gates[0].m_Lo && y <= gates[0].m_Hi ) ||
+				 ( y >= gates[1].m_Lo && y <= gates[1].m_Hi ) )
+			{
+				classes |= 1 << c;
+			}
+		}
+		return classes;
+	}
+
+private:
+	std::vector<Gate>	m_Gates;
+	int					m_NumClasses;
+}; // ChromaClassTable
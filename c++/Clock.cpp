@@ -0,0 +1,60 @@
+#include "Clock.h"
+
+#include <thread>
+#include <chrono>
+
+//=======================================================================
+Clock::Clock()
+	: m_Mode( REAL_TIME )
+	, m_Speed( 1.0 )
+	, m_FrameRate( 30.0 )
+	, m_Started( false )
+	, m_StartWall( 0.0 )
+	, m_StartMedia( 0.0 )
+	, m_LastTime( 0.0 )
+{}
+
+//=======================================================================
+double Clock::Stamp( const FrameInfo& info, const bool hasSourceTime )
+{
+	if ( m_Mode == REAL_TIME )
+	{
+		return info.m_CaptureTime;
+	}
+
+	// recorded time of this frame
+	const double media = hasSourceTime ? info.m_SourceTime : info.m_Index * 1000.0 / m_FrameRate;
+
+	if ( !m_Started )
+	{
+		m_Started = true;
+		m_StartWall = FrameInfo::Now();
+		m_StartMedia = media;
+		m_LastTime = 0.0;
+	}
+
+	double t = media - m_StartMedia;
+
+	if ( t < m_LastTime )
+	{
+		// went back (seek, loop): carry on one frame after the last one,
+		// time stamps must never go backwards
+		t = m_LastTime + 1000.0 / m_FrameRate;
+		m_StartMedia = media - t;
+	}
+
+	m_LastTime = t;
+
+	if ( m_Mode == PACED )
+	{
+		// hold the frame back until it's due
+		const double wait = m_StartWall + t / m_Speed - FrameInfo::Now();
+		if ( wait > 0.0 )
+		{
+			std::this_thread::sleep_for( std::chrono::duration<double, std::milli>( wait ) );
+		}
+	}
+
+	// on the wall clock's scale, so it can still be compared with FrameInfo::Now()
+	return m_StartWall + t;
+} // Stamp
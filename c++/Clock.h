@@ -0,0 +1,64 @@
+#pragma once
+
+#include "FrameInfo.h"
+
+//===================================================================================
+// Decides the capture time stamped on every frame, which is the only time the
+// processing (BotManager, Camera, Robot, FPSCalculator) ever sees.
+// - REAL_TIME: the wall time the frame was captured at. For live input
+// - PACED:     the recorded time line, and frames are held back until the wall clock
+//              catches up with it (optionally sped up)
+// - VIRTUAL:   the recorded time line, frames are delivered as fast as possible
+// With PACED and VIRTUAL, a replay gives the same time stamps, hence the same
+// decisions, whatever speed it runs at.
+//===================================================================================
+class Clock
+{
+public:
+	enum MODE { REAL_TIME = 0, PACED, VIRTUAL };
+
+	Clock();
+
+	void SetMode( const MODE m )
+	{
+		m_Mode = m;
+	}
+
+	MODE GetMode() const
+	{
+		return m_Mode;
+	}
+
+	// PACED: 1 = as recorded, 2 = twice as fast ...
+	void SetSpeed( const double s )
+	{
+		m_Speed = s > 0.0 ? s : 1.0;
+	}
+
+	// nominal frame rate of sources without time stamps (e.g. images)
+	void SetFrameRate( const double fps )
+	{
+		m_FrameRate = fps > 0.0 ? fps : 30.0;
+	}
+
+	// start the time line again with the next frame
+	void Reset()
+	{
+		m_Started = false;
+	}
+
+	// @brief: capture time of a frame (ms), see the modes above
+	// hasSourceTime: whether info.m_SourceTime is the frame's recorded time;
+	// if not, frames are assumed to be 1 / frame rate apart
+	double Stamp( const FrameInfo& info, const bool hasSourceTime );
+
+private:
+	MODE	m_Mode;
+	double	m_Speed;
+	double	m_FrameRate;
+
+	bool	m_Started;		// the time line has started
+	double	m_StartWall;	// wall time of the first frame (ms)
+	double	m_StartMedia;	// recorded time of the first frame (ms)
+	double	m_LastTime;		// time line position of the last frame (ms), relative to the first
+}; // Clock
@@ -0,0 +1,17 @@
+#include "ColorClassLut.h"
+
+//===================================================================================
+ColorClassLut::ColorClassLut()
+	: m_Bits( 0 )
+	, m_Shift( 8 )
+{}
+
+//===================================================================================
+void ColorClassLut::Create( const int bits )
+{
+	CV_Assert( bits >= 1 && bits <= 8 );
+
+	m_Bits = bits;
+	m_Shift = 8 - bits;
+	m_Table.resize( static_cast<size_t>( 1 ) << ( 3 * bits ) );
+} // Create
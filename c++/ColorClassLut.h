@@ -0,0 +1,62 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+//===================================================================================
+// Maps a BGR color straight to the bits of its color classes (bit c: class c,
+// see ColorSegmenter). Each channel is quantized to 2^bits levels: with 8 bits the
+// table is exact and takes 16 MB, with 6 bits it takes 256 KB and fits in L2,
+// but the colors of a cell all get the classes of its center color.
+// The table is filled one blue level (a plane of green x red) at a time.
+//===================================================================================
+class ColorClassLut
+{
+public:
+	ColorClassLut();
+
+	// allocate the table, bits per channel in [1, 8]. The content is undefined
+	void Create( const int bits );
+
+	bool IsCreated() const
+	{
+		return !m_Table.empty();
+	}
+
+	int GetBits() const
+	{
+		return m_Bits;
+	}
+
+	int GetNumLevels() const
+	{
+		return 1 << m_Bits;
+	}
+
+	// the center color of a level
+	uchar GetLevelColor( const int level ) const
+	{
+		return static_cast<uchar>( ( level << m_Shift ) + ( ( 1 << m_Shift ) >> 1 ) );
+	}
+
+	// the classes of blue level b, indexed by green level * GetNumLevels() + red level
+	uchar* GetPlane( const int b )
+	{
+		return &m_Table[static_cast<size_t>( b ) << ( 2 * m_Bits )];
+	}
+
+	// the classes of a BGR pixel
+	uchar Lookup( const uchar* bgr ) const
+	{
+		return m_Table[
+			( static_cast<size_t>( bgr[0] >> m_Shift ) << ( 2 * m_Bits ) ) |
+			( ( bgr[1] >> m_Shift ) << m_Bits ) |
+			( bgr[2] >> m_Shift )];
+	}
+
+private:
+	std::vector<uchar>	m_Table;
+	int					m_Bits;		// per channel
+	int					m_Shift;	// 8 - m_Bits
+}; // ColorClassLut
@@ -0,0 +1,674 @@
+#include "ColorSegmenter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#if defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ )
+#define COLOR_SEGMENTER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__( ( target( "avx2" ) ) )
+#endif
+#endif // x86
+
+namespace
+{
+	const int HSV_SHIFT = 12;
+	const int H_RANGE = 180;
+
+	//===================================================================================
+	// the division tables of OpenCV's 8 bit BGR to HSV conversion
+	struct HsvTables
+	{
+		HsvTables()
+		{
+			m_SDiv[0] = m_HDiv[0] = 0;
+			for ( int i = 1; i < 256; i++ )
+			{
+				m_SDiv[i] = cvRound( ( 255 << HSV_SHIFT ) / ( 1.0 * i ) );
+				m_HDiv[i] = cvRound( ( H_RANGE << HSV_SHIFT ) / ( 6.0 * i ) );
+			}
+
+			// 8 mask bytes (0 or 255) for each combination of 8 bits
+			for ( int bits = 0; bits < 256; bits++ )
+			{
+				uint64_t bytes = 0;
+				for ( int i = 0; i < 8; i++ )
+				{
+					if ( bits & ( 1 << i ) )
+					{
+						bytes |= static_cast<uint64_t>( 0xFF ) << ( 8 * i );
+					}
+				}
+				m_ByteMasks[bits] = bytes;
+			}
+		}
+
+		int			m_SDiv[256];
+		int			m_HDiv[256];
+		uint64_t	m_ByteMasks[256];
+	}; // HsvTables
+
+	const HsvTables& GetTables()
+	{
+		static const HsvTables tables;
+		return tables;
+	}
+
+	//===================================================================================
+	// what one row of a kernel needs
+	struct RowParams
+	{
+		const uchar*	m_Bgr;
+		const uchar*	m_Mask;		// NULL: no mask
+		uchar*			m_Out[ColorSegmenter::MAX_CLASSES]; // NULL: class not wanted
+		int				m_Width;
+		int				m_NumRanges[ColorSegmenter::MAX_CLASSES];
+		const cv::Vec6i* m_Ranges[ColorSegmenter::MAX_CLASSES];
+	}; // RowParams
+
+	//===================================================================================
+	// pixels [x0, width) of a row, one at a time
+	void SegmentRowScalar( const RowParams& p, const int x0 )
+	{
+		const HsvTables& t = GetTables();
+
+		for ( int x = x0; x < p.m_Width; x++ )
+		{
+			const uchar* px = p.m_Bgr + 3 * x;
+			const int b = px[0];
+			const int g = px[1];
+			const int r = px[2];
+
+			const int v = std::max( b, std::max( g, r ) );
+			const int diff = v - std::min( b, std::min( g, r ) );
+			const int vr = v == r ? -1 : 0;
+			const int vg = v == g ? -1 : 0;
+
+			const int s = ( diff * t.m_SDiv[v] + ( 1 << ( HSV_SHIFT - 1 ) ) ) >> HSV_SHIFT;
+			int h = ( vr & ( g - b ) ) +
+				( ~vr & ( ( vg & ( b - r + 2 * diff ) ) + ( ( ~vg ) & ( r - g + 4 * diff ) ) ) );
+			h = ( h * t.m_HDiv[diff] + ( 1 << ( HSV_SHIFT - 1 ) ) ) >> HSV_SHIFT;
+			h += h < 0 ? H_RANGE : 0;
+
+			const bool valid = p.m_Mask == NULL || p.m_Mask[x] != 0;
+
+			for ( int c = 0; c < ColorSegmenter::MAX_CLASSES; c++ )
+			{
+				if ( p.m_Out[c] == NULL )
+				{
+					continue;
+				}
+
+				bool in = false;
+				for ( int i = 0; i < p.m_NumRanges[c] && !in; i++ )
+				{
+					const cv::Vec6i& rg = p.m_Ranges[c][i];
+					in = h >= rg[0] && h <= rg[3] &&
+						 s >= rg[1] && s <= rg[4] &&
+						 v >= rg[2] && v <= rg[5];
+				}
+
+				p.m_Out[c][x] = valid && in ? 255 : 0;
+			}
+		}
+	} // SegmentRowScalar
+
+#ifdef COLOR_SEGMENTER_X86
+	//===================================================================================
+	// 8 pixels at a time, in 32 bit lanes. Returns the first pixel not done
+	AVX2_TARGET int SegmentRowAvx2( const RowParams& p )
+	{
+		const HsvTables& t = GetTables();
+
+		// the bounds of every range, lower - 1 and upper + 1 for cmpgt
+		__m256i lo[ColorSegmenter::MAX_CLASSES][ColorSegmenter::MAX_RANGES][3];
+		__m256i hi[ColorSegmenter::MAX_CLASSES][ColorSegmenter::MAX_RANGES][3];
+
+		for ( int c = 0; c < ColorSegmenter::MAX_CLASSES; c++ )
+		{
+			for ( int i = 0; i < p.m_NumRanges[c]; i++ )
+			{
+				for ( int k = 0; k < 3; k++ )
+				{
+					lo[c][i][k] = _mm256_set1_epi32( p.m_Ranges[c][i][k] - 1 );
+					hi[c][i][k] = _mm256_set1_epi32( p.m_Ranges[c][i][k + 3] + 1 );
+				}
+			}
+		}
+
+		// 8 BGR pixels are 24 bytes: words 0-2 go to the low lane, words 3-5 to the high one,
+		// then each lane spreads its 4 pixels over 32 bit elements
+		const __m256i perm = _mm256_setr_epi32( 0, 1, 2, 3, 3, 4, 5, 6 );
+		const __m256i shufB = _mm256_setr_epi8(
+			0, -1, -1, -1, 3, -1, -1, -1, 6, -1, -1, -1, 9, -1, -1, -1,
+			0, -1, -1, -1, 3, -1, -1, -1, 6, -1, -1, -1, 9, -1, -1, -1 );
+		const __m256i shufG = _mm256_setr_epi8(
+			1, -1, -1, -1, 4, -1, -1, -1, 7, -1, -1, -1, 10, -1, -1, -1,
+			1, -1, -1, -1, 4, -1, -1, -1, 7, -1, -1, -1, 10, -1, -1, -1 );
+		const __m256i shufR = _mm256_setr_epi8(
+			2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1,
+			2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1 );
+
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i half = _mm256_set1_epi32( 1 << ( HSV_SHIFT - 1 ) );
+		const __m256i hRange = _mm256_set1_epi32( H_RANGE );
+
+		int x = 0;
+
+		// a load reads 32 bytes, i.e. up to 10.67 pixels
+		for ( ; x + 11 <= p.m_Width; x += 8 )
+		{
+			__m256i px = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p.m_Bgr + 3 * x ) );
+			px = _mm256_permutevar8x32_epi32( px, perm );
+
+			const __m256i b = _mm256_shuffle_epi8( px, shufB );
+			const __m256i g = _mm256_shuffle_epi8( px, shufG );
+			const __m256i r = _mm256_shuffle_epi8( px, shufR );
+
+			const __m256i v = _mm256_max_epi32( b, _mm256_max_epi32( g, r ) );
+			const __m256i diff = _mm256_sub_epi32( v, _mm256_min_epi32( b, _mm256_min_epi32( g, r ) ) );
+			const __m256i vr = _mm256_cmpeq_epi32( v, r );
+			const __m256i vg = _mm256_cmpeq_epi32( v, g );
+
+			const __m256i sDiv = _mm256_i32gather_epi32( t.m_SDiv, v, 4 );
+			const __m256i s = _mm256_srli_epi32( _mm256_add_epi32( _mm256_mullo_epi32( diff, sDiv ), half ), HSV_SHIFT );
+
+			const __m256i hR = _mm256_sub_epi32( g, b );
+			const __m256i hG = _mm256_add_epi32( _mm256_sub_epi32( b, r ), _mm256_slli_epi32( diff, 1 ) );
+			const __m256i hB = _mm256_add_epi32( _mm256_sub_epi32( r, g ), _mm256_slli_epi32( diff, 2 ) );
+			__m256i h = _mm256_blendv_epi8( _mm256_blendv_epi8( hB, hG, vg ), hR, vr );
+
+			const __m256i hDiv = _mm256_i32gather_epi32( t.m_HDiv, diff, 4 );
+			h = _mm256_srai_epi32( _mm256_add_epi32( _mm256_mullo_epi32( h, hDiv ), half ), HSV_SHIFT );
+			h = _mm256_add_epi32( h, _mm256_and_si256( _mm256_cmpgt_epi32( zero, h ), hRange ) );
+
+			__m256i valid = _mm256_cmpeq_epi32( zero, zero );
+			if ( p.m_Mask != NULL )
+			{
+				const __m256i m = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( p.m_Mask + x ) ) );
+				valid = _mm256_cmpgt_epi32( m, zero );
+			}
+
+			const __m256i hsv[3] = { h, s, v };
+
+			for ( int c = 0; c < ColorSegmenter::MAX_CLASSES; c++ )
+			{
+				if ( p.m_Out[c] == NULL )
+				{
+					continue;
+				}
+
+				__m256i in = zero;
+				for ( int i = 0; i < p.m_NumRanges[c]; i++ )
+				{
+					__m256i inRange = valid;
+					for ( int k = 0; k < 3; k++ )
+					{
+						inRange = _mm256_and_si256( inRange, _mm256_cmpgt_epi32( hsv[k], lo[c][i][k] ) );
+						inRange = _mm256_and_si256( inRange, _mm256_cmpgt_epi32( hi[c][i][k], hsv[k] ) );
+					}
+					in = _mm256_or_si256( in, inRange );
+				}
+
+				const int bits = _mm256_movemask_ps( _mm256_castsi256_ps( in ) );
+				std::memcpy( p.m_Out[c] + x, &t.m_ByteMasks[bits], 8 );
+			}
+		} // for ( ; x + 11 <= p.m_Width; x += 8 )
+
+		return x;
+	} // SegmentRowAvx2
+#endif // COLOR_SEGMENTER_X86
+
+	//===================================================================================
+	// write the classes of pixels [x0, x0 + n) to the class masks, in loops the compiler
+	// can vectorize. classes is cleared where the mask is 0
+	void SpreadClasses( const RowParams& p, const int x0, const int n, uchar* classes )
+	{
+		if ( p.m_Mask != NULL )
+		{
+			const uchar* mask = p.m_Mask + x0;
+			for ( int i = 0; i < n; i++ )
+			{
+				classes[i] &= static_cast<uchar>( -( mask[i] != 0 ) );
+			}
+		}
+
+		for ( int c = 0; c < ColorSegmenter::MAX_CLASSES; c++ )
+		{
+			if ( p.m_Out[c] == NULL )
+			{
+				continue;
+			}
+
+			uchar* out = p.m_Out[c] + x0;
+			for ( int i = 0; i < n; i++ )
+			{
+				out[i] = static_cast<uchar>( -( ( classes[i] >> c ) & 1 ) );
+			}
+		}
+	} // SpreadClasses
+
+	const int CHUNK = 256; // pixels looked up before they're spread, even
+
+	//===================================================================================
+	// one table lookup per pixel. The classes of a chunk of pixels are looked up first,
+	// then spread to the class masks
+	void SegmentRowLut( const RowParams& p, const ColorClassLut& lut )
+	{
+		uchar classes[CHUNK];
+
+		for ( int x0 = 0; x0 < p.m_Width; x0 += CHUNK )
+		{
+			const int n = std::min( CHUNK, p.m_Width - x0 );
+			const uchar* bgr = p.m_Bgr + 3 * x0;
+
+			for ( int i = 0; i < n; i++ )
+			{
+				classes[i] = lut.Lookup( bgr + 3 * i );
+			}
+
+			SpreadClasses( p, x0, n, classes );
+		}
+	} // SegmentRowLut
+
+	//===================================================================================
+	// a YUYV row, in p.m_Bgr: Y0 U Y1 V for each pair of pixels. The gates of a chroma
+	// are looked up once per pair, then both lumas go through them.
+	// oddStart: the row starts at the second pixel of a pair
+	void SegmentRowYuyv( const RowParams& p, const ChromaClassTable& table, const bool oddStart )
+	{
+		uchar classes[CHUNK];
+
+		// CHUNK is even, so every chunk starts like the row
+		for ( int x0 = 0; x0 < p.m_Width; x0 += CHUNK )
+		{
+			const int n = std::min( CHUNK, p.m_Width - x0 );
+			const uchar* yuyv = p.m_Bgr + 2 * x0;
+
+			int i = 0;
+			if ( oddStart )
+			{
+				// U is before the Y
+				classes[0] = table.Lookup( table.GetGates( yuyv[-1], yuyv[1] ), yuyv[0] );
+				i = 1;
+			}
+
+			for ( ; i + 1 < n; i += 2 )
+			{
+				const uchar* pair = yuyv + 2 * i;
+				const ChromaClassTable::Gate* gates = table.GetGates( pair[1], pair[3] );
+
+				classes[i] = table.Lookup( gates, pair[0] );
+				classes[i + 1] = table.Lookup( gates, pair[2] );
+			}
+
+			if ( i < n )
+			{
+				// the pair goes on in the next chunk
+				const uchar* pair = yuyv + 2 * i;
+				classes[i] = table.Lookup( table.GetGates( pair[1], pair[3] ), pair[0] );
+			}
+
+			SpreadClasses( p, x0, n, classes );
+		}
+	} // SegmentRowYuyv
+
+	//===================================================================================
+	// the BGR of a YUV color, like cv::cvtColor( COLOR_YUV2BGR_YUYV ) (ITU-R BT.601)
+	void YuvToBgr( const int y, const int u, const int v, uchar* bgr )
+	{
+		const int SHIFT = 20;
+		const int CY = 1220542;
+		const int CUB = 2116026;
+		const int CUG = -409993;
+		const int CVG = -852492;
+		const int CVR = 1673527;
+
+		const int ruv = ( 1 << ( SHIFT - 1 ) ) + CVR * ( v - 128 );
+		const int guv = ( 1 << ( SHIFT - 1 ) ) + CVG * ( v - 128 ) + CUG * ( u - 128 );
+		const int buv = ( 1 << ( SHIFT - 1 ) ) + CUB * ( u - 128 );
+		const int yy = std::max( 0, y - 16 ) * CY;
+
+		bgr[0] = cv::saturate_cast<uchar>( ( yy + buv ) >> SHIFT );
+		bgr[1] = cv::saturate_cast<uchar>( ( yy + guv ) >> SHIFT );
+		bgr[2] = cv::saturate_cast<uchar>( ( yy + ruv ) >> SHIFT );
+	} // YuvToBgr
+} // namespace
+
+//===================================================================================
+ColorSegmenter::ColorSegmenter()
+	: m_Kernel( SIMD )
+	, m_LutBits( 8 )
+	, m_LutValid( false )
+	, m_ChromaValid( false )
+{
+	for ( int c = 0; c < MAX_CLASSES; c++ )
+	{
+		m_NumRanges[c] = 0;
+	}
+}
+
+//===================================================================================
+void ColorSegmenter::SetClass( const int cls, const cv::Vec6i* ranges, const int numRanges )
+{
+	CV_Assert( cls >= 0 && cls < MAX_CLASSES && numRanges >= 0 && numRanges <= MAX_RANGES );
+
+	for ( int i = 0; i < numRanges; i++ )
+	{
+		m_Ranges[cls][i] = ranges[i];
+	}
+	m_NumRanges[cls] = numRanges;
+	m_LutValid = false;
+	m_ChromaValid = false;
+} // SetClass
+
+//===================================================================================
+ColorSegmenter::KERNEL ColorSegmenter::GetKernel() const
+{
+	if ( m_Kernel == LUT )
+	{
+		return LUT;
+	}
+
+	return m_Kernel == SIMD && HasAvx2() ? SIMD : SCALAR;
+} // GetKernel
+
+//===================================================================================
+void ColorSegmenter::SetLutBits( const int bits )
+{
+	CV_Assert( bits >= 1 && bits <= 8 );
+
+	if ( bits != m_LutBits )
+	{
+		m_LutBits = bits;
+		m_LutValid = false;
+	}
+} // SetLutBits
+
+//===================================================================================
+void ColorSegmenter::Prepare( const int type ) const
+{
+	if ( type == CV_8UC2 )
+	{
+		if ( !m_ChromaValid )
+		{
+			BuildChromaTable();
+		}
+	}
+	else if ( GetKernel() == LUT && !m_LutValid )
+	{
+		BuildLut();
+	}
+} // Prepare
+
+//===================================================================================
+void ColorSegmenter::Segment(
+	const cv::Mat& img,
+	const cv::Mat& mask,
+	cv::Mat* classMasks ) const
+{
+	cv::Mat* out[MAX_CLASSES];
+	for ( int c = 0; c < MAX_CLASSES; c++ )
+	{
+		out[c] = m_NumRanges[c] > 0 ? &classMasks[c] : NULL;
+	}
+
+	SegmentClasses( img, mask, out, GetKernel() );
+} // Segment
+
+//===================================================================================
+void ColorSegmenter::Segment(
+	const cv::Mat& img,
+	const cv::Mat& mask,
+	const int cls,
+	cv::Mat& classMask ) const
+{
+	CV_Assert( cls >= 0 && cls < MAX_CLASSES );
+
+	cv::Mat* out[MAX_CLASSES] = {};
+	out[cls] = &classMask;
+
+	SegmentClasses( img, mask, out, GetKernel() );
+} // Segment
+
+//===================================================================================
+void ColorSegmenter::SegmentClasses(
+	const cv::Mat& img,
+	const cv::Mat& mask,
+	cv::Mat* const* classMasks,
+	const KERNEL kernel ) const
+{
+	CV_Assert( img.type() == CV_8UC3 || img.type() == CV_8UC2 );
+	CV_Assert( mask.empty() || ( mask.type() == CV_8UC1 && mask.size() == img.size() ) );
+
+	if ( img.type() == CV_8UC2 )
+	{
+		SegmentYuyv( img, mask, classMasks );
+		return;
+	}
+
+	const cv::Mat& bgr = img;
+
+	if ( kernel == LUT && !m_LutValid )
+	{
+		BuildLut();
+	}
+
+	RowParams p;
+	p.m_Width = bgr.cols;
+
+	for ( int c = 0; c < MAX_CLASSES; c++ )
+	{
+		p.m_NumRanges[c] = m_NumRanges[c];
+		p.m_Ranges[c] = m_Ranges[c];
+
+		if ( classMasks[c] != NULL )
+		{
+			classMasks[c]->create( bgr.size(), CV_8UC1 );
+		}
+	}
+
+	for ( int y = 0; y < bgr.rows; y++ )
+	{
+		p.m_Bgr = bgr.ptr<uchar>( y );
+		p.m_Mask = mask.empty() ? NULL : mask.ptr<uchar>( y );
+
+		for ( int c = 0; c < MAX_CLASSES; c++ )
+		{
+			p.m_Out[c] = classMasks[c] != NULL ? classMasks[c]->ptr<uchar>( y ) : NULL;
+		}
+
+		if ( kernel == LUT )
+		{
+			SegmentRowLut( p, m_Lut );
+			continue;
+		}
+
+		int x = 0;
+#ifdef COLOR_SEGMENTER_X86
+		if ( kernel == SIMD )
+		{
+			x = SegmentRowAvx2( p );
+		}
+#endif // COLOR_SEGMENTER_X86
+
+		SegmentRowScalar( p, x );
+	}
+} // SegmentClasses
+
+//===================================================================================
+void ColorSegmenter::SegmentYuyv(
+	const cv::Mat& yuyv,
+	const cv::Mat& mask,
+	cv::Mat* const* classMasks ) const
+{
+	if ( !m_ChromaValid )
+	{
+		BuildChromaTable();
+	}
+
+	RowParams p;
+	p.m_Width = yuyv.cols;
+
+	for ( int c = 0; c < MAX_CLASSES; c++ )
+	{
+		if ( classMasks[c] != NULL )
+		{
+			classMasks[c]->create( yuyv.size(), CV_8UC1 );
+		}
+	}
+
+	// which pixel of a pair comes first depends on where the view starts in the image
+	cv::Size wholeSize;
+	cv::Point ofs;
+	yuyv.locateROI( wholeSize, ofs );
+
+	const bool oddStart = ( ofs.x & 1 ) != 0;
+
+	for ( int y = 0; y < yuyv.rows; y++ )
+	{
+		p.m_Bgr = yuyv.ptr<uchar>( y );
+		p.m_Mask = mask.empty() ? NULL : mask.ptr<uchar>( y );
+
+		for ( int c = 0; c < MAX_CLASSES; c++ )
+		{
+			p.m_Out[c] = classMasks[c] != NULL ? classMasks[c]->ptr<uchar>( y ) : NULL;
+		}
+
+		SegmentRowYuyv( p, m_Chroma, oddStart );
+	}
+} // SegmentYuyv
+
+//===================================================================================
+void ColorSegmenter::BuildLut() const
+{
+	m_Lut.Create( m_LutBits );
+
+	const int n = m_Lut.GetNumLevels();
+	const KERNEL kernel = HasAvx2() ? SIMD : SCALAR;
+
+	cv::Mat* out[MAX_CLASSES];
+	for ( int c = 0; c < MAX_CLASSES; c++ )
+	{
+		out[c] = m_NumRanges[c] > 0 ? &m_LutMasks[c] : NULL;
+	}
+
+	// every green x red center color of a blue level, classified like any image
+	m_LutColors.create( n, n, CV_8UC3 );
+
+	for ( int b = 0; b < n; b++ )
+	{
+		for ( int g = 0; g < n; g++ )
+		{
+			uchar* px = m_LutColors.ptr<uchar>( g );
+			for ( int r = 0; r < n; r++, px += 3 )
+			{
+				px[0] = m_Lut.GetLevelColor( b );
+				px[1] = m_Lut.GetLevelColor( g );
+				px[2] = m_Lut.GetLevelColor( r );
+			}
+		}
+
+		SegmentClasses( m_LutColors, cv::Mat(), out, kernel );
+
+		uchar* plane = m_Lut.GetPlane( b );
+		for ( int g = 0; g < n; g++ )
+		{
+			for ( int r = 0; r < n; r++ )
+			{
+				uchar classes = 0;
+				for ( int c = 0; c < MAX_CLASSES; c++ )
+				{
+					if ( out[c] != NULL && out[c]->ptr<uchar>( g )[r] != 0 )
+					{
+						classes |= 1 << c;
+					}
+				}
+				plane[g * n + r] = classes;
+			}
+		}
+	}
+
+	m_LutValid = true;
+} // BuildLut
+
+//===================================================================================
+void ColorSegmenter::BuildChromaTable() const
+{
+	m_Chroma.Create( MAX_CLASSES );
+
+	const KERNEL kernel = HasAvx2() ? SIMD : SCALAR;
+
+	cv::Mat* out[MAX_CLASSES];
+	for ( int c = 0; c < MAX_CLASSES; c++ )
+	{
+		out[c] = m_NumRanges[c] > 0 ? &m_LutMasks[c] : NULL;
+	}
+
+	// the colors of every U (row) x Y (column) of a V, classified like any image
+	m_LutColors.create( 256, 256, CV_8UC3 );
+
+	for ( int v = 0; v < 256; v++ )
+	{
+		for ( int u = 0; u < 256; u++ )
+		{
+			uchar* px = m_LutColors.ptr<uchar>( u );
+			for ( int y = 0; y < 256; y++, px += 3 )
+			{
+				YuvToBgr( y, u, v, px );
+			}
+		}
+
+		SegmentClasses( m_LutColors, cv::Mat(), out, kernel );
+
+		for ( int u = 0; u < 256; u++ )
+		{
+			for ( int c = 0; c < MAX_CLASSES; c++ )
+			{
+				if ( out[c] != NULL )
+				{
+					m_Chroma.SetClass( u, v, c, out[c]->ptr<uchar>( u ) );
+				}
+			}
+		}
+	}
+
+	m_ChromaValid = true;
+} // BuildChromaTable
+
+//===================================================================================
+bool ColorSegmenter::HasAvx2()
+{
+#if defined( COLOR_SEGMENTER_X86 ) && defined( _MSC_VER )
+	static const bool hasAvx2 = []()
+	{
+		int info[4];
+		__cpuid( info, 0 );
+		if ( info[0] < 7 )
+		{
+			return false;
+		}
+
+		// the OS must save the YMM registers
+		__cpuid( info, 1 );
+		const bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+		if ( !osxsave || ( _xgetbv( 0 ) & 6 ) != 6 )
+		{
+			return false;
+		}
+
+		__cpuidex( info, 7, 0 );
+		return ( info[1] & ( 1 << 5 ) ) != 0;
+	}();
+	return hasAvx2;
+#elif defined( COLOR_SEGMENTER_X86 )
+	return __builtin_cpu_supports( "avx2" ) != 0;
+#else
+	return false;
+#endif
+} // HasAvx2
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "ColorClassLut.h"
+#include "ChromaClassTable.h"
+
+//===================================================================================
+// Classifies the pixels of a BGR image by color, in one pass over the image.
+// A color class is a set of up to MAX_RANGES ranges in OpenCV's 8 bit HSV
+// (H: 0-180, S, V: 0-255, bounds included like cv::inRange); a pixel is in the class
+// if it's in any of its ranges. Segment() writes a binary mask (0/255) per class.
+// The HSV conversion is bit-exact with cv::cvtColor( CV_BGR2HSV ), but the HSV
+// image is never stored.
+// The SIMD kernel (AVX2) is picked at run time; the scalar one is the reference.
+// The LUT kernel skips HSV: it looks the classes of each pixel up in a ColorClassLut,
+// rebuilt on the first Segment() after the classes change.
+// YUYV images (the camera's own 4:2:2) are classified without any conversion, by the
+// chroma of each pixel pair and the luma of each pixel, see ChromaClassTable. The
+// classes are those of the image converted by cv::cvtColor( COLOR_YUV2BGR_YUYV ),
+// up to the edges of the classes.
+// Rebuilding the tables isn't thread safe: call Prepare() before segmenting on several
+// threads at once.
+//===================================================================================
+class ColorSegmenter
+{
+public:
+	enum { MAX_CLASSES = 4, MAX_RANGES = 2 };
+
+	enum KERNEL { SCALAR = 0, SIMD, LUT };
+
+	ColorSegmenter();
+
+	// set the HSV ranges of class cls. numRanges = 0 removes the class
+	void SetClass( const int cls, const cv::Vec6i* ranges, const int numRanges );
+
+	// SIMD runs the scalar kernel when the CPU can't do AVX2
+	void SetKernel( const KERNEL k )
+	{
+		m_Kernel = k;
+	}
+
+	// the kernel actually used
+	KERNEL GetKernel() const;
+
+	// LUT kernel: bits per channel of the table, 8 is exact (see ColorClassLut)
+	void SetLutBits( const int bits );
+
+	// classify the pixels of img, BGR (CV_8UC3) or YUYV (CV_8UC2), where mask
+	// (CV_8UC1, optional) isn't 0. The kernel only applies to BGR.
+	// classMasks[cls] receives the mask of class cls, for each class that is set
+	void Segment(
+		const cv::Mat& img,
+		const cv::Mat& mask,
+		cv::Mat* classMasks ) const;
+
+	// same, for class cls only
+	void Segment(
+		const cv::Mat& img,
+		const cv::Mat& mask,
+		const int cls,
+		cv::Mat& classMask ) const;
+
+	// build now what the next Segment() of an image of type would build,
+	// so Segment() only reads
+	void Prepare( const int type = CV_8UC3 ) const;
+
+	static bool HasAvx2();
+
+private:
+
+	// classify into the classes whose mask isn't NULL
+	void SegmentClasses(
+		const cv::Mat& img,
+		const cv::Mat& mask,
+		cv::Mat* const* classMasks,
+		const KERNEL kernel ) const;
+
+	// the YUYV part of SegmentClasses()
+	void SegmentYuyv(
+		const cv::Mat& yuyv,
+		const cv::Mat& mask,
+		cv::Mat* const* classMasks ) const;
+
+	// fill m_Lut with the HSV kernels
+	void BuildLut() const;
+
+	// fill m_Chroma with the HSV kernels
+	void BuildChromaTable() const;
+
+	int			m_NumRanges[MAX_CLASSES];
+	cv::Vec6i	m_Ranges[MAX_CLASSES][MAX_RANGES];
+	KERNEL		m_Kernel;
+	int			m_LutBits;
+
+	// built lazily, by Segment()
+	mutable ColorClassLut		m_Lut;
+	mutable bool				m_LutValid;
+	mutable ChromaClassTable	m_Chroma;
+	mutable bool				m_ChromaValid;
+	mutable cv::Mat				m_LutColors;	// center colors of a blue level, or the colors of a V
+	mutable cv::Mat				m_LutMasks[MAX_CLASSES];
+}; // ColorSegmenter
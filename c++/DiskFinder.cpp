@@ -1,146 +1,193 @@
 #include "DiskFinder.h"
+#include "Utility.h"
 
 //#define DEBUG
 //===================================================================================
-bool DiskFinder::FindDisk1Thresh(
-	Contours& contours,
+DiskFinder::DiskFinder()
+	: m_AreaLow( 0.0 )
+	, m_AreaHigh( 0.0 )
+	, m_Streaks( false )
+	, m_Segmenter( NULL )
+	, m_Class( 0 )
+{}
+
+//===================================================================================
+bool DiskFinder::FindDisk(
+	Blob& disk,
 	cv::Point& center,
-	const cv::Mat& hsvImg,
-	const cv::Vec6i& thresh,
-	const cv::Mat& mask )
+	const cv::Mat& binImg,
+	const cv::Mat& bgrImg,
+	const cv::Mat& bgrMask,
+	const cv::Point& offset )
 {
-	// use color threshold
-
-	cv::Mat res;
-	cv::inRange( hsvImg, cv::Scalar( thresh[0], thresh[1], thresh[2] ), cv::Scalar( thresh[3], thresh[4], thresh[5] ), res );
-
 #ifdef DEBUG
-	cv::imshow( "res mask", res );
+	cv::imshow( "res + mask", binImg );
 #endif // DEBUG
 
-	if ( !mask.empty() )
+	if ( !bgrImg.empty() && bgrImg.cols > binImg.cols && m_Segmenter != NULL )
 	{
-		cv::bitwise_and( res, mask, res );
+		return FindDiskCoarseToFine( disk, center, binImg, bgrImg, bgrMask, offset );
 	}
 
-#ifdef DEBUG
-	cv::imshow( "res + mask", res );
-#endif // DEBUG
+	RemoveNoiseAndFindBlobs( m_Blobs, binImg, offset );
 
-	return FindDiskInternal( contours, center, res );
+	return SelectDisk( disk, center, m_Blobs );
 
-}// FindDisk1Thresh
+}// FindDisk
 
 //===================================================================================
-bool DiskFinder::FindDisk2Thresh(
-	Contours& contours,
-	cv::Point& center,
-	const cv::Mat& hsvImg,
-	const cv::Vec6i& thresh1,
-	const cv::Vec6i& thresh2,
-	const cv::Mat& mask )
+void DiskFinder::RemoveNoiseAndFindBlobs(
+	std::vector<Blob>& found,
+	const cv::Mat& res,
+	const cv::Point& offset )
 {
-	// use color threshold
-	cv::Mat mask1;
-	cv::inRange( hsvImg, cv::Scalar( thresh1[0], thresh1[1], thresh1[2] ), cv::Scalar( thresh1[3], thresh1[4], thresh1[5] ), mask1 );
+	// 1 bit per pixel from here on, the morphology works on 64 pixels at once
+	m_Bits.Pack( res );
 
-	cv::Mat mask2;
-	cv::inRange( hsvImg, cv::Scalar( thresh2[0], thresh2[1], thresh2[2] ), cv::Scalar( thresh2[3], thresh2[4], thresh2[5] ), mask2 );
+	// remove noise in background: opening
+	m_BitsTmp.Erode( m_Bits );
+	m_Bits.Dilate( m_BitsTmp );
 
-	cv::Mat res;
-	cv::bitwise_or( mask1, mask2, res );
+	// remove noise in foreground: closing
+	m_BitsTmp.Dilate( m_Bits );
+	m_Bits.Erode( m_BitsTmp );
 
 #ifdef DEBUG
-	cv::imshow( "res mask", res );
+	cv::Mat show;
+	m_Bits.Unpack( show );
+	cv::imshow( "res + mask + noise removal", show );
 #endif // DEBUG
 
-	if ( !mask.empty() )
-	{
-		cv::bitwise_and( res, mask, res );
-	}
-
-#ifdef DEBUG
-	cv::imshow( "res + mask", res );
-#endif // DEBUG
-
-	return FindDiskInternal( contours, center, res );
-
-}// FindDisk2Thresh
+	m_Extractor.Extract( m_Bits, found, offset );
+} // RemoveNoiseAndFindBlobs
 
 //===================================================================================
-bool DiskFinder::FindDiskInternal(
-	Contours& contours,
+bool DiskFinder::SelectDisk(
+	Blob& disk,
 	cv::Point& center,
-	const cv::Mat& mask )
+	const std::vector<Blob>& candidates )
 {
-	contours.clear(); // reset contour
-
-	cv::Mat ellipse = cv::getStructuringElement( cv::MORPH_ELLIPSE, cv::Size( 5, 5 ) );
-
-	// remove noise in background
-	cv::morphologyEx( mask, mask, cv::MORPH_OPEN, ellipse, cv::Point( -1, -1 ), 1/*num iteration*/ );
-
-	// remove noise in foreground
-	cv::morphologyEx( mask, mask, cv::MORPH_CLOSE, ellipse, cv::Point( -1, -1 ), 1/*num iteration*/ );
-
-#ifdef DEBUG
-	cv::imshow( "res + mask + noise removal", mask );
-#endif // DEBUG
-
-	std::vector<std::vector<cv::Point> > tmpContours;
-	std::vector<std::vector<cv::Point> > tmpContours2;
-	std::vector<cv::Vec4i> hierarchy;
-	std::vector<double> roundness;
-
-	cv::findContours( mask, tmpContours, hierarchy, CV_RETR_CCOMP, CV_CHAIN_APPROX_SIMPLE );
-
 	// locate puck by 1. area, 2. roundness, and 3. color(has already been used at the begining)
-	for ( int i = 0; i< tmpContours.size(); i++ )
+	// if more than one survives, choose the one that has the closest-to-1 roundness
+	int idx = -1;
+	double minDiff = 100000.0;
+
+	for ( int i = 0; i < candidates.size(); i++ )
 	{
 		// 1. test area
-		double area = cv::contourArea( tmpContours[i] );
+		double area = candidates[i].m_Area;
 		if ( area > m_AreaLow && area < m_AreaHigh )
 		{
-			// 2. test roundness
-			double perimeter = cv::arcLength( tmpContours[i], true /*is closed*/ );
+			// 2. test roundness. From the pixel count and the crack length it's about 7% lower
+			// than it was from the contour (a disk of r = 10 px: 10.8 instead of 11.9), well inside the limits
+			double perimeter = candidates[i].GetPerimeter();
 			double tmpRoundness = perimeter * perimeter  *  0.78539815 / area; // if it's a circle, = 1, because perimeter = 2 * PI * r, area = PI * r^2
 
 			if ( tmpRoundness < 20.0 && tmpRoundness > 0.05 )
 			{
 				// survived
-				tmpContours2.push_back( tmpContours[i] );
-				roundness.push_back( tmpRoundness );
+				double absDif = std::abs( tmpRoundness - 1.0 );
+				if ( absDif < minDiff )
+				{
+					idx = i;
+					minDiff = absDif;
+				}
 			}
 		}
-	} // for ( int i = 0; i< puckContours.size(); i++ )
+	} // for ( int i = 0; i < candidates.size(); i++ )
 
-	if ( tmpContours2.size() == 1 )
+	if ( idx < 0 && m_Streaks )
 	{
-		contours.push_back( tmpContours2[0] );
-		cv::Moments m = cv::moments( contours[0] );
-		center.x = static_cast<int>( m.m10 / m.m00 );
-		center.y = static_cast<int>( m.m01 / m.m00 );
-	}
-	else if ( tmpContours2.size() > 1 )
-	{
-		// choose the one that has the closest-to-1 roundness
-		double minDiff = 100000.0;
-		int idx = -1;
-		for ( int i = 0; i < tmpContours2.size(); i++ )
+		// too long for a disk: the longest streak as wide as the disk
+		double maxLength = 0.0;
+
+		for ( int i = 0; i < candidates.size(); i++ )
 		{
-			double absDif = std::abs( roundness[i] - 1.0 );
-			if ( absDif < minDiff )
+			cv::Point2d dir;
+			double length;
+			const double r = candidates[i].GetStreak( dir, length );
+			const double diskArea = 3.1415926 * r * r;
+
+			if ( diskArea > m_AreaLow && diskArea < m_AreaHigh && length > maxLength )
 			{
 				idx = i;
-				minDiff = absDif;
+				maxLength = length;
 			}
-		} // for
-		contours.push_back( tmpContours2[idx] );
+		}
+	}
 
-		cv::Moments m = cv::moments( contours[0] );
-		center.x = static_cast<int>( m.m10 / m.m00 );
-		center.y = static_cast<int>( m.m01 / m.m00 );
+	if ( idx < 0 )
+	{
+		return false;
 	}
 
-	return contours.size() == 1;
-} // FindDiskInternal
+	disk = candidates[idx];
+
+	const cv::Point2d c = disk.GetCentroid();
+	center.x = static_cast<int>( c.x );
+	center.y = static_cast<int>( c.y );
+
+	return true;
+} // SelectDisk
+
+//===================================================================================
+bool DiskFinder::FindDiskCoarseToFine(
+	Blob& disk,
+	cv::Point& center,
+	const cv::Mat& binImg,
+	const cv::Mat& bgrImg,
+	const cv::Mat& bgrMask,
+	const cv::Point& offset )
+{
+	// the blobs of the coarse binImg are only candidates. No noise removal at this level:
+	// the 5x5 opening would erase a puck at 1/4 resolution
+	m_Extractor.Extract( binImg, m_Blobs );
+
+	const double scale = static_cast<double>( bgrImg.cols ) / binImg.cols;
+
+	// loose bounds on the area: the edges are blurred by the down-sampling
+	const double areaLow = 0.25 * m_AreaLow / ( scale * scale );
+	const double areaHigh = ( m_Streaks ? 8.0 : 2.0 ) * m_AreaHigh / ( scale * scale ); // streaks are larger
+
+	// the window covers the rounding of the coarse position, and the 5x5 structuring element
+	const int margin = static_cast<int>( std::ceil( scale ) ) + 5;
+	const cv::Rect imgRect( 0, 0, bgrImg.cols, bgrImg.rows );
+
+	m_FineBlobs.clear();
+	int numCandidates = 0;
+
+	for ( int i = 0; i < m_Blobs.size() && numCandidates < MAX_CANDIDATES; i++ )
+	{
+		const cv::Rect& r = m_Blobs[i].m_BoundingBox;
+		const double area = m_Blobs[i].m_Area;
+
+		if ( area < areaLow || area > areaHigh )
+		{
+			continue;
+		}
+
+		numCandidates++;
+
+		// the candidate's window in full resolution
+		cv::Rect win(
+			static_cast<int>( r.x * scale ) - margin,
+			static_cast<int>( r.y * scale ) - margin,
+			static_cast<int>( std::ceil( r.width * scale ) ) + 2 * margin,
+			static_cast<int>( std::ceil( r.height * scale ) ) + 2 * margin );
+
+		win &= imgRect;
+
+		cv::Mat winRes = Utility::GrowOnlyView( m_WinRes, win.size(), CV_8UC1 );
+
+		m_Segmenter->Segment( bgrImg( win ), bgrMask.empty() ? cv::Mat() : bgrMask( win ), m_Class, winRes );
+
+		RemoveNoiseAndFindBlobs( m_WinBlobs, winRes, win.tl() + offset );
+
+		// keep the blobs of all windows
+		m_FineBlobs.insert( m_FineBlobs.end(), m_WinBlobs.begin(), m_WinBlobs.end() );
+	} // for ( int i = 0; i < m_Blobs.size() && numCandidates < MAX_CANDIDATES; i++ )
+
+	// the full resolution area and roundness tests decide
+	return SelectDisk( disk, center, m_FineBlobs );
+
+} // FindDiskCoarseToFine
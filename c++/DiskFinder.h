@@ -5,30 +5,42 @@
 #include <opencv2/video.hpp>
 #include <opencv2/imgproc.hpp>
 
-typedef std::vector<std::vector<cv::Point> > Contours;
+#include "ColorSegmenter.h"
+#include "BlobExtractor.h"
+#include "BitMask.h"
 
 class DiskFinder
 {
 public:
+	DiskFinder();
+
 	//============================================
-	// @param [out] contours of puck of size 1
-	// @param [out] puckCenter : center of puck contour
-	// @param [in] hsvImg : input HSV image
-	// @param [in] mask: input mask
-	bool FindDisk1Thresh(
-		Contours& contours,
+	// @param [out] disk : the blob of the disk
+	// @param [out] center : center of the disk
+	// @param [in] binImg : the pixels of the disk color (see ColorSegmenter). Noise is
+	//                      removed in a bit-packed copy (see BitMask)
+	// @param [in] bgrImg: optional full resolution BGR image. If it's larger than binImg,
+	//                     binImg is from a down-sampled copy of it: the disk is searched
+	//                     in binImg, then the candidates are refined in small full resolution
+	//                     windows of bgrImg (coarse-to-fine), classified by the color class
+	//                     given to SetColorClass()
+	// @param [in] bgrMask: mask of bgrImg
+	// @param [in] offset: where binImg, or bgrImg if given, is in the image when it's
+	//                     a window of it. disk and center are in image coordinate
+	bool FindDisk(
+		Blob& disk,
 		cv::Point& center,
-		const cv::Mat& hsvImg,		//HSV imag
-		const cv::Vec6i& thresh,
-		const cv::Mat& mask = cv::Mat() );
+		const cv::Mat& binImg,
+		const cv::Mat& bgrImg = cv::Mat(),
+		const cv::Mat& bgrMask = cv::Mat(),
+		const cv::Point& offset = cv::Point() );
 
-	bool FindDisk2Thresh(
-		Contours& contours,
-		cv::Point& center,
-		const cv::Mat& hsvImg,
-		const cv::Vec6i& thresh1,
-		const cv::Vec6i& thresh2,
-		const cv::Mat& mask = cv::Mat() );
+	// the color class of the disk, to refine coarse candidates. segmenter isn't owned
+	void SetColorClass( const ColorSegmenter* segmenter, const int cls )
+	{
+		m_Segmenter = segmenter;
+		m_Class = cls;
+	}
 
 	void SetAreaLow( const double low )
 	{
@@ -40,13 +52,57 @@ public:
 		m_AreaHigh = high;
 	}
 
+	// when no blob passes as a disk, accept a motion blur streak: a blob as wide as
+	// the disk, longer than it (see Blob::GetStreak)
+	void SetStreaks( const bool ok )
+	{
+		m_Streaks = ok;
+	}
+
 private:
 
-	bool FindDiskInternal(
-		Contours& contours,
+	// max number of coarse candidates refined at full resolution
+	static const int MAX_CANDIDATES = 8;
+
+	// remove noise in the binary image res, and find its blobs, shifted by offset
+	void RemoveNoiseAndFindBlobs(
+		std::vector<Blob>& found,
+		const cv::Mat& res,
+		const cv::Point& offset = cv::Point() );
+
+	// find the disk among the candidates
+	bool SelectDisk(
+		Blob& disk,
+		cv::Point& center,
+		const std::vector<Blob>& candidates );
+
+	// find the disk candidates in the down-sampled binImg, and refine them in bgrImg
+	bool FindDiskCoarseToFine(
+		Blob& disk,
 		cv::Point& center,
-		const cv::Mat& mask = cv::Mat() );
+		const cv::Mat& binImg,
+		const cv::Mat& bgrImg,
+		const cv::Mat& bgrMask,
+		const cv::Point& offset );
 
 	double	m_AreaLow;
 	double	m_AreaHigh;
+	bool	m_Streaks;
+
+	const ColorSegmenter*	m_Segmenter;
+	int						m_Class;
+
+	// workspace, allocated once per resolution and reused every frame
+	BitMask	m_Bits;			// binImg packed, then with the noise removed
+	BitMask	m_BitsTmp;		// m_Bits after the first half of opening / closing
+
+	BlobExtractor		m_Extractor;
+	std::vector<Blob>	m_Blobs;		// all blobs in binImg
+
+	// coarse-to-fine workspace. The windows differ in size every frame, so they're views
+	// into buffers that only grow
+	cv::Mat	m_WinRes;		// pixels of the disk color in a full resolution window
+
+	std::vector<Blob>	m_WinBlobs;		// blobs in m_WinRes
+	std::vector<Blob>	m_FineBlobs;	// refined candidates of all windows
 }; // DiskFinder
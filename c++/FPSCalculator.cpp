@@ -2,20 +2,36 @@
 //=============================================
 FPSCalculator::FPSCalculator()
 	: m_BufferSize( 0 )
+	, m_NumFrameTime( 0 )
+	, m_Next( 0 )
+	, m_PrevCaptureTime( -1.0 )
 {}
 
+//=============================================
+void FPSCalculator::SetBufferSize( const int m )
+{
+	m_BufferSize = m;
+	m_FrameTimeBuffer.assign( m > 0 ? m : 0, 0.0f );
+	m_NumFrameTime = 0;
+	m_Next = 0;
+}// SetBufferSize
+
 //=============================================
 unsigned int FPSCalculator::GetFPS()
 {
-	float s = static_cast<float>( m_FrameTimeBuffer.size() );
+	float s = static_cast<float>( m_NumFrameTime );
 
 	float sum( 0 );
 
-	std::list<int>::iterator it = m_FrameTimeBuffer.begin();
+	for ( int i = 0; i < m_NumFrameTime; i++ )
+	{
+		sum += m_FrameTimeBuffer[i];
+	}
 
-	for ( int i = 0; i < s; i++, it++ )
+	// no frame time yet: the first frame has no previous capture time
+	if ( sum <= 0.0f )
 	{
-		sum += static_cast<float>( *it );
+		return 0;
 	}
 
 	unsigned int fps = static_cast<unsigned int>( s / sum * 1000.0f + 0.5f );
@@ -24,15 +40,31 @@ unsigned int FPSCalculator::GetFPS()
 }
 
 //=============================================
-void FPSCalculator::AddFrameTime( const int dt /*ms*/ )
+void FPSCalculator::AddFrameTime( const float dt /*ms*/ )
 {
-	int s = static_cast<int>( m_FrameTimeBuffer.size() );
+	if ( m_BufferSize <= 0 )
+	{
+		return;
+	}
 
-	if ( s >= m_BufferSize )
+	// overwrite the oldest entry once the ring is full
+	m_FrameTimeBuffer[m_Next] = dt;
+	m_Next = ( m_Next + 1 ) % m_BufferSize;
+
+	if ( m_NumFrameTime < m_BufferSize )
 	{
-		m_FrameTimeBuffer.pop_front();
+		m_NumFrameTime++;
 	}
 
-	m_FrameTimeBuffer.push_back( dt );
+}// AddFrameTime
+
+//=============================================
+void FPSCalculator::AddFrame( const FrameInfo& info )
+{
+	if ( m_PrevCaptureTime >= 0.0 )
+	{
+		AddFrameTime( static_cast<float>( info.m_CaptureTime - m_PrevCaptureTime ) );
+	}
 
-}// AddFrameTime
\ No newline at end of file
+	m_PrevCaptureTime = info.m_CaptureTime;
+}// AddFrame
\ No newline at end of file
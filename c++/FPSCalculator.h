@@ -1,5 +1,7 @@
 #pragma once
-#include <list>
+#include <vector>
+
+#include "FrameInfo.h"
 
 class FPSCalculator
 {
@@ -7,13 +9,17 @@ public:
 	FPSCalculator();
 
 	unsigned int GetFPS();
-	void AddFrameTime( const int dt /*ms*/ );
-	void SetBufferSize( const int m )
-	{
-		m_BufferSize = m;
-	}
+	void AddFrameTime( const float dt /*ms*/ );
+
+	// add the interval between this frame's capture time and the previous one's
+	void AddFrame( const FrameInfo& info );
+	// resets the buffer; the storage is allocated here, not per frame
+	void SetBufferSize( const int m );
 
 private:
-	std::list<int>		m_FrameTimeBuffer;
+	std::vector<float>	m_FrameTimeBuffer;	// ring of the latest frame times
 	int					m_BufferSize;
+	int					m_NumFrameTime;		// number of valid entries in the ring
+	int					m_Next;				// ring slot for the next frame time
+	double				m_PrevCaptureTime; // ms. negative: no frame yet
 };//FPSCalculator
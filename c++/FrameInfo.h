@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+
+//===================================================================================
+// The envelope that travels with every frame from capture to FrameProcessor::Process.
+// All times are in ms. Capture and dequeue times come from a monotonic clock
+// (see FrameInfo::Now), so they can be differenced to get real inter-frame intervals.
+//===================================================================================
+class FrameInfo
+{
+public:
+	FrameInfo()
+		: m_Index( -1 )
+		, m_CaptureTime( 0.0 )
+		, m_SourceTime( 0.0 )
+		, m_DequeueTime( 0.0 )
+	{}
+
+	// monotonic wall clock, in ms
+	static double Now()
+	{
+		return std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now().time_since_epoch() ).count();
+	}
+
+	long	m_Index;		// frame index in the input sequence
+	double	m_CaptureTime;	// when the frame came out of the capture device (monotonic, ms)
+	double	m_SourceTime;	// time stamp reported by the source, CAP_PROP_POS_MSEC (ms). 0 if undefined
+	double	m_DequeueTime;	// when the processing loop picked the frame up (monotonic, ms)
+}; // FrameInfo
@@ -0,0 +1,139 @@
+#include "FrameRing.h"
+
+#include <chrono>
+
+//=======================================================================
+FrameRing::FrameRing()
+	: m_Newest( 0 )
+	, m_Writing( 0 )
+	, m_NumWritten( 0 )
+	, m_LastRead( 0 )
+	, m_NumDropped( 0 )
+	, m_NumDuplicated( 0 )
+	, m_Closed( false )
+{}
+
+//=======================================================================
+void FrameRing::Init( const unsigned int numSlots, const cv::Size& size, const int type )
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	// need at least 2 slots: one being read, one being written
+	const unsigned int n = numSlots < 2 ? 2 : numSlots;
+
+	m_Slots.resize( n );
+	m_Infos.assign( n, FrameInfo() );
+	for ( unsigned int i = 0; i < n; i++ )
+	{
+		m_Slots[i].create( size, type );
+	}
+
+	m_Newest = 0;
+	m_Writing = 0;
+	m_NumWritten = 0;
+	m_LastRead = 0;
+	m_NumDropped = 0;
+	m_NumDuplicated = 0;
+	m_Closed = false;
+} // Init
+
+//=======================================================================
+cv::Mat& FrameRing::BeginWrite()
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	// the slot after the newest one is never the one being read
+	m_Writing = ( m_Newest + 1 ) % m_Slots.size();
+	return m_Slots[m_Writing];
+} // BeginWrite
+
+//=======================================================================
+void FrameRing::EndWrite( const FrameInfo& info )
+{
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+		m_Infos[m_Writing] = info;
+		m_Newest = m_Writing;
+		m_NumWritten++;
+	}
+
+	m_NewFrame.notify_one();
+} // EndWrite
+
+//=======================================================================
+void FrameRing::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+		m_Closed = true;
+	}
+
+	m_NewFrame.notify_all();
+} // Close
+
+//=======================================================================
+bool FrameRing::ReadLatest( cv::Mat& frame, FrameInfo& info, const int timeoutMs )
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	auto hasNewFrame = [this]() { return m_NumWritten > m_LastRead || m_Closed; };
+
+	if ( timeoutMs < 0 )
+	{
+		m_NewFrame.wait( lock, hasNewFrame );
+	}
+	else
+	{
+		m_NewFrame.wait_for( lock, std::chrono::milliseconds( timeoutMs ), hasNewFrame );
+	}
+
+	if ( m_NumWritten > m_LastRead )
+	{
+		// everything between the last read and the newest frame is stale
+		m_NumDropped += m_NumWritten - m_LastRead - 1;
+		m_LastRead = m_NumWritten;
+
+		m_Slots[m_Newest].copyTo( frame );
+		info = m_Infos[m_Newest];
+		return true;
+	}
+
+	if ( m_Closed || m_LastRead == 0 )
+	{
+		return false;
+	}
+
+	// timed out, hand back the previous frame
+	m_NumDuplicated++;
+	m_Slots[m_Newest].copyTo( frame );
+	info = m_Infos[m_Newest];
+	return true;
+} // ReadLatest
+
+//=======================================================================
+long FrameRing::GetLastReadIndex() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_LastRead;
+}
+
+//=======================================================================
+long FrameRing::GetNumWritten() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_NumWritten;
+}
+
+//=======================================================================
+long FrameRing::GetNumDropped() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_NumDropped;
+}
+
+//=======================================================================
+long FrameRing::GetNumDuplicated() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+	return m_NumDuplicated;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "FrameInfo.h"
+
+//===================================================================================
+// A small ring of preallocated frame slots shared by the capture thread (writer)
+// and the processing loop (reader).
+// The writer fills the slot after the newest one and publishes it, so it never
+// touches the frame the reader is copying. The reader always takes the newest
+// complete frame; any frame overwritten before it was read is counted as dropped.
+//===================================================================================
+class FrameRing
+{
+public:
+	FrameRing();
+
+	// allocate the slots. Must be called before the capture thread starts
+	void Init( const unsigned int numSlots, const cv::Size& size, const int type );
+
+	//=======================================
+	// writer side (capture thread)
+	//=======================================
+
+	// the slot to capture into. Only valid until EndWrite()
+	cv::Mat& BeginWrite();
+
+	// publish the slot filled since BeginWrite(), along with its envelope
+	void EndWrite( const FrameInfo& info );
+
+	// no more frames will be written, wakes up the reader
+	void Close();
+
+	//=======================================
+	// reader side (processing loop)
+	//=======================================
+
+	// @brief: copy the newest frame into "frame" and its envelope into "info".
+	// Waits up to timeoutMs for a frame that hasn't been read yet
+	// (negative: wait until one arrives or the ring is closed).
+	// If it times out, the previous frame is handed back again and counted as duplicated.
+	// @return false if the ring is closed and there's no new frame, or nothing was ever written
+	bool ReadLatest( cv::Mat& frame, FrameInfo& info, const int timeoutMs );
+
+	// sequence number (1-based) of the frame last returned by ReadLatest
+	long GetLastReadIndex() const;
+
+	long GetNumWritten() const;
+
+	// frames overwritten before the reader got to them
+	long GetNumDropped() const;
+
+	// frames handed to the reader more than once
+	long GetNumDuplicated() const;
+
+private:
+	std::vector<cv::Mat>		m_Slots;
+	std::vector<FrameInfo>		m_Infos;		// envelope of each slot
+	unsigned int				m_Newest;		// slot index of the newest published frame
+	unsigned int				m_Writing;		// slot index the writer is filling
+	long						m_NumWritten;	// sequence number of the newest published frame
+	long						m_LastRead;		// sequence number of the last frame read
+	long						m_NumDropped;
+	long						m_NumDuplicated;
+	bool						m_Closed;
+
+	mutable std::mutex			m_Mutex;
+	std::condition_variable		m_NewFrame;
+}; // FrameRing
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "FrameInfo.h"
+
+//===================================================================================
+// Where VideoProcessor gets its frames from: a capture device, a list of image
+// files, a raw recording, a generated scene ...
+// Opening is specific to each source; everything after that goes through here.
+//===================================================================================
+class FrameSource
+{
+public:
+	enum PIXEL_FORMAT { BGR = 0, YUYV }; // CV_8UC3, or CV_8UC2 (4:2:2)
+
+	virtual ~FrameSource() {}
+
+	virtual bool IsOpened() const = 0;
+
+	virtual void Close() = 0;
+
+	// @brief: grab the next frame into "frame", and stamp its index and time stamps into "info"
+	// frame is in GetPixelFormat(). If IsZeroCopy(), it refers to memory owned by the source
+	// and is only valid until the next Grab(); copy it to keep it longer.
+	// @return false if there are no more frames
+	virtual bool Grab( cv::Mat& frame, FrameInfo& info ) = 0;
+
+	// size of the frames as they come out of Grab()
+	virtual cv::Size GetFrameSize() = 0;
+
+	virtual PIXEL_FORMAT GetPixelFormat() const
+	{
+		return BGR;
+	}
+
+	// whether Grab() stamps FrameInfo::m_SourceTime with the frame's recorded time
+	virtual bool HasSourceTime() const
+	{
+		return true;
+	}
+
+	// whether Grab() hands out the source's own buffer instead of a new one
+	virtual bool IsZeroCopy() const
+	{
+		return false;
+	}
+
+	// frame number of the next frame
+	virtual long GetFrameNumber() = 0;
+
+	// number of frames, 0 if unknown (live)
+	virtual long GetTotalFrameCount()
+	{
+		return 0;
+	}
+
+	// position of the next frame in ms, 0 if undefined
+	virtual double GetPositionMS()
+	{
+		return 0.0;
+	}
+
+	// 0 if undefined
+	virtual double GetFrameRate()
+	{
+		return 0.0;
+	}
+
+	// fourcc of the source's codec, -1 if undefined
+	virtual int GetCodec( char codec[4] )
+	{
+		return -1;
+	}
+
+	// go to this frame number
+	virtual bool SetFrameNumber( long pos )
+	{
+		return false;
+	}
+
+	// go to this position
+	virtual bool SetPositionMS( double pos )
+	{
+		return false;
+	}
+
+	// go to this position expressed in fraction of the total length
+	virtual bool SetRelativePosition( double pos )
+	{
+		return false;
+	}
+}; // FrameSource
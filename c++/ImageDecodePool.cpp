@@ -0,0 +1,146 @@
+#include "ImageDecodePool.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+//=======================================================================
+ImageDecodePool::ImageDecodePool()
+	: m_Files( NULL )
+	, m_NextToClaim( 0 )
+	, m_NextToDeliver( 0 )
+	, m_Stop( false )
+{}
+
+//=======================================================================
+ImageDecodePool::~ImageDecodePool()
+{
+	Stop();
+}
+
+//=======================================================================
+void ImageDecodePool::Start(
+	const std::vector<std::string>& files,
+	const size_t first,
+	const unsigned int numThreads,
+	const unsigned int depth,
+	const cv::Mat& firstImage )
+{
+	Stop();
+
+	const unsigned int n = numThreads < 1 ? 1 : numThreads;
+
+	// each worker needs a slot of its own to decode into
+	const unsigned int d = depth < n ? n : depth;
+
+	m_Files = &files;
+	m_Slots.assign( d, Slot() );
+	m_NextToClaim = first;
+	m_NextToDeliver = first;
+	m_Stop = false;
+
+	if ( !firstImage.empty() && first < files.size() )
+	{
+		Slot& slot = m_Slots[first % d];
+		slot.m_Image = firstImage;
+		slot.m_Index = static_cast<long>( first );
+		slot.m_Ready = true;
+		m_NextToClaim++;
+	}
+
+	for ( unsigned int i = 0; i < n; i++ )
+	{
+		m_Workers.push_back( std::thread( &ImageDecodePool::DecodeLoop, this ) );
+	}
+} // Start
+
+//=======================================================================
+void ImageDecodePool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+		m_Stop = true;
+	}
+
+	m_SlotFreed.notify_all();
+	m_SlotReady.notify_all();
+
+	for ( size_t i = 0; i < m_Workers.size(); i++ )
+	{
+		m_Workers[i].join();
+	}
+
+	m_Workers.clear();
+	m_Slots.clear();
+} // Stop
+
+//=======================================================================
+void ImageDecodePool::DecodeLoop()
+{
+	const size_t depth = m_Slots.size();
+
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	while ( true )
+	{
+		// don't run more than "depth" frames ahead of the reader, so the slot
+		// of the claimed frame has always been popped already
+		m_SlotFreed.wait( lock, [this, depth]()
+		{
+			return m_Stop || m_NextToClaim >= m_Files->size() || m_NextToClaim < m_NextToDeliver + depth;
+		} );
+
+		if ( m_Stop || m_NextToClaim >= m_Files->size() )
+		{
+			break;
+		}
+
+		const size_t idx = m_NextToClaim++;
+
+		// decode without holding the lock, this is where the workers run in parallel
+		lock.unlock();
+		cv::Mat img = cv::imread( ( *m_Files )[idx] );
+		lock.lock();
+
+		Slot& slot = m_Slots[idx % depth];
+		slot.m_Image = img;
+		slot.m_Index = static_cast<long>( idx );
+		slot.m_Ready = true;
+
+		m_SlotReady.notify_all();
+	}
+} // DecodeLoop
+
+//=======================================================================
+bool ImageDecodePool::Pop( cv::Mat& frame, long& index )
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	if ( m_Slots.empty() || m_NextToDeliver >= m_Files->size() )
+	{
+		return false;
+	}
+
+	Slot& slot = m_Slots[m_NextToDeliver % m_Slots.size()];
+
+	m_SlotReady.wait( lock, [this, &slot]()
+	{
+		return m_Stop || ( slot.m_Ready && slot.m_Index == static_cast<long>( m_NextToDeliver ) );
+	} );
+
+	if ( m_Stop )
+	{
+		return false;
+	}
+
+	// hand the decoded buffer over rather than copying it
+	frame = slot.m_Image;
+	slot.m_Image.release();
+	slot.m_Ready = false;
+	index = slot.m_Index;
+
+	m_NextToDeliver++;
+
+	lock.unlock();
+	m_SlotFreed.notify_all();
+
+	return true;
+} // Pop
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//===================================================================================
+// Decodes an image sequence ahead of the processing loop on a pool of worker threads.
+// Workers claim the next file in sequence order and decode it into a bounded queue
+// of "depth" slots, so at most "depth" frames are decoded ahead of the reader.
+// The reader gets the frames strictly in sequence order, whichever worker finishes first.
+//===================================================================================
+class ImageDecodePool
+{
+public:
+	ImageDecodePool();
+
+	~ImageDecodePool();
+
+	// @brief: start decoding files[first], files[first+1], ... until the end of files.
+	// files must stay untouched until Stop().
+	// firstImage: files[first] if it's already decoded (not decoded again), or empty
+	void Start(
+		const std::vector<std::string>& files,
+		const size_t first,
+		const unsigned int numThreads,
+		const unsigned int depth,
+		const cv::Mat& firstImage = cv::Mat() );
+
+	// stop and join the workers, and drop the frames decoded ahead
+	void Stop();
+
+	bool IsRunning() const
+	{
+		return !m_Workers.empty();
+	}
+
+	// @brief: the next frame in sequence order, waits until it's decoded.
+	// frame is empty if the file couldn't be decoded.
+	// index: position of the frame in the file vector
+	// @return false if there are no more frames
+	bool Pop( cv::Mat& frame, long& index );
+
+private:
+	struct Slot
+	{
+		Slot() : m_Index( -1 ), m_Ready( false ) {}
+
+		cv::Mat	m_Image;
+		long	m_Index;	// position in the file vector
+		bool	m_Ready;	// decoded, not yet popped
+	};
+
+	// worker thread body
+	void DecodeLoop();
+
+	const std::vector<std::string>*	m_Files;
+	std::vector<Slot>				m_Slots;	// slot of frame i is i % depth
+
+	size_t						m_NextToClaim;		// next file a worker will decode
+	size_t						m_NextToDeliver;	// next file Pop() returns
+	bool						m_Stop;
+
+	std::vector<std::thread>	m_Workers;
+
+	std::mutex					m_Mutex;
+	std::condition_variable		m_SlotFreed;	// workers wait for room in the queue
+	std::condition_variable		m_SlotReady;	// reader waits for the next frame
+}; // ImageDecodePool
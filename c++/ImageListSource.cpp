@@ -0,0 +1,160 @@
+#include "ImageListSource.h"
+#include "AllocCounter.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+//=======================================================================
+ImageListSource::ImageListSource()
+	: m_DecodeThreads( 0 )
+	, m_DecodeDepth( 8 )
+	, m_PeekIndex( -1 )
+{
+	m_ItImg = m_Images.begin();
+}
+
+//=======================================================================
+void ImageListSource::Open( const std::vector<std::string>& imgs )
+{
+	// the pool refers to the old vector
+	Close();
+
+	// the input will be this vector of m_Images
+	m_Images = imgs;
+	m_ItImg = m_Images.begin();
+}
+
+//=======================================================================
+void ImageListSource::Close()
+{
+	ResetDecodeAhead();
+	m_ImageSize = cv::Size();
+	m_Images.clear();
+	m_ItImg = m_Images.begin();
+}
+
+//=======================================================================
+void ImageListSource::SetDecodeAhead( const unsigned int numThreads, const unsigned int depth )
+{
+	m_DecodeThreads = numThreads;
+	m_DecodeDepth = depth;
+	m_DecodePool.Stop();
+}
+
+//=======================================================================
+void ImageListSource::ResetDecodeAhead()
+{
+	m_DecodePool.Stop();
+	m_PeekImage.release();
+	m_PeekIndex = -1;
+}
+
+//=======================================================================
+bool ImageListSource::Grab( cv::Mat& frame, FrameInfo& info )
+{
+	if ( m_ItImg == m_Images.end() )
+	{
+		return false;
+	}
+
+	long idx = static_cast<long>( m_ItImg - m_Images.begin() );
+
+	if ( m_DecodeThreads > 0 )
+	{
+		if ( !m_DecodePool.IsRunning() )
+		{
+			// the pool takes over the image GetFrameSize() may have decoded
+			m_DecodePool.Start( m_Images, idx, m_DecodeThreads, m_DecodeDepth,
+				m_PeekIndex == idx ? m_PeekImage : cv::Mat() );
+
+			m_PeekImage.release();
+			m_PeekIndex = -1;
+		}
+
+		if ( !m_DecodePool.Pop( frame, idx ) )
+		{
+			return false;
+		}
+
+		m_ItImg = m_Images.begin() + idx + 1;
+	}
+	else
+	{
+		//printf( "%s\n", ( *m_ItImg ).c_str() ); // debug: print file path
+		if ( m_PeekIndex == idx )
+		{
+			frame = m_PeekImage;
+			m_PeekImage.release();
+			m_PeekIndex = -1;
+		}
+		else
+		{
+			// a decode makes a new image every time, with or without the pool: it's
+			// the source's work, not the frame loop's, so don't count it
+			const bool counting = AllocCounter::SetCounting( false );
+			frame = cv::imread( *m_ItImg );
+			AllocCounter::SetCounting( counting );
+		}
+
+		m_ItImg++;
+	}
+
+	info.m_CaptureTime = FrameInfo::Now();
+	info.m_SourceTime = 0.0; // undefined for images
+	info.m_Index = idx;
+
+	if ( frame.data != 0 && m_ImageSize.area() == 0 )
+	{
+		m_ImageSize = frame.size();
+	}
+
+	return frame.data != 0;
+} // Grab
+
+//=======================================================================
+cv::Size ImageListSource::GetFrameSize()
+{
+	// decode the next image once, and keep it for when it's grabbed
+	if ( m_ImageSize.area() == 0 && m_ItImg != m_Images.end() && !m_DecodePool.IsRunning() )
+	{
+		m_PeekIndex = static_cast<long>( m_ItImg - m_Images.begin() );
+		m_PeekImage = cv::imread( *m_ItImg );
+		m_ImageSize = m_PeekImage.size();
+	}
+
+	return m_ImageSize;
+} // GetFrameSize
+
+//=======================================================================
+bool ImageListSource::SetFrameNumber( long pos )
+{
+	if ( pos < 0 || pos > static_cast<long>( m_Images.size() ) )
+	{
+		return false;
+	}
+
+	// the images decoded ahead are from the old position
+	ResetDecodeAhead();
+
+	// move to position in vector
+	m_ItImg = m_Images.begin() + pos;
+	return true;
+} // SetFrameNumber
+
+//=======================================================================
+bool ImageListSource::SetRelativePosition( double pos )
+{
+	// move to position in vector
+	long posI = static_cast<long>( pos * m_Images.size() + 0.5 );
+
+	// is it a valid position?
+	if ( posI < 0 || posI >= static_cast<long>( m_Images.size() ) )
+	{
+		return false;
+	}
+
+	// the images decoded ahead are from the old position
+	ResetDecodeAhead();
+
+	m_ItImg = m_Images.begin() + posI;
+	return true;
+} // SetRelativePosition
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <vector>
+
+#include "FrameSource.h"
+#include "ImageDecodePool.h"
+
+//===================================================================================
+// Frames from a list of image files, optionally decoded ahead on a pool of threads
+//===================================================================================
+class ImageListSource : public FrameSource
+{
+public:
+	ImageListSource();
+
+	void Open( const std::vector<std::string>& imgs );
+
+	bool IsOpened() const override
+	{
+		return !m_Images.empty();
+	}
+
+	void Close() override;
+
+	// decode ahead on numThreads worker threads, at most depth images ahead.
+	// numThreads = 0 decodes each image in Grab()
+	void SetDecodeAhead( const unsigned int numThreads, const unsigned int depth );
+
+	bool Grab( cv::Mat& frame, FrameInfo& info ) override;
+
+	// images carry no time stamps
+	bool HasSourceTime() const override
+	{
+		return false;
+	}
+
+	// decodes the next image if no image was decoded yet, and keeps it for Grab()
+	cv::Size GetFrameSize() override;
+
+	long GetFrameNumber() override
+	{
+		return static_cast<long>( m_ItImg - m_Images.begin() );
+	}
+
+	long GetTotalFrameCount() override
+	{
+		return static_cast<long>( m_Images.size() );
+	}
+
+	bool SetFrameNumber( long pos ) override;
+
+	bool SetRelativePosition( double pos ) override;
+
+private:
+	// to forget the images decoded ahead, e.g. when the position changes
+	void ResetDecodeAhead();
+
+	// vector of image filename to be used as input
+	std::vector<std::string> m_Images;
+
+	// image vector iterator
+	std::vector<std::string>::const_iterator m_ItImg;
+
+	// number of threads decoding ahead, 0: decode in Grab()
+	unsigned int m_DecodeThreads;
+
+	// number of images decoded ahead at most
+	unsigned int m_DecodeDepth;
+
+	// decodes ahead, started at the current position on the first Grab()
+	ImageDecodePool m_DecodePool;
+
+	// image decoded by GetFrameSize(), kept so it isn't decoded again when it's grabbed
+	cv::Mat m_PeekImage;
+
+	// position of m_PeekImage in m_Images, -1: none
+	long m_PeekIndex;
+
+	// size of the images, empty until one is decoded
+	cv::Size m_ImageSize;
+}; // ImageListSource
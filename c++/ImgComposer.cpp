@@ -14,7 +14,7 @@
 #define ORANGE cv::Scalar( 0, 128, 255 )
 
 //===============================================================
-void ImgComposer::Process( cv::Mat & input, cv::Mat & output )
+void ImgComposer::Process( cv::Mat & input, cv::Mat & output, const FrameInfo& info )
 {
 	std::ifstream log;
 	log.open( "Log.txt", std::ifstream::in );
@@ -13,7 +13,7 @@ class ImgComposer : public FrameProcessor
 {
 public:
 	//bool ReadLog();
-	void Process( cv::Mat & input, cv::Mat & output ) override;
+	void Process( cv::Mat & input, cv::Mat & output, const FrameInfo& info ) override;
 private:
 	std::vector<cv::Point>	m_Corners;
 };//ImgComposer
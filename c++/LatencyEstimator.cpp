@@ -0,0 +1,255 @@
+#include "LatencyEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define STEP				4.0		// ms between samples
+#define WINDOW				250		// samples (1 s) cross-correlated
+#define MAX_LAG				50		// samples (200 ms)
+#define MODEL_SAMPLES		512		// > WINDOW + MAX_LAG
+#define NUM_POSITIONS		256		// > 1 s of detections
+#define MAX_GAP				100.0	// ms without the robot seen: the window is skipped
+#define ESTIMATE_INTERVAL	250.0	// ms between windows
+#define MIN_MOVE			20.0f	// mm, std of the commanded motion over a window
+#define MIN_CORRELATION		0.9f	// of the peak
+#define GAIN				0.2f	// weight of a new estimate
+
+//===================================================================================
+LatencyEstimator::LatencyEstimator()
+	: m_Latency( 0.0f )
+	, m_NumEstimates( 0 )
+	, m_Accel( 0.01f, 0.01f )
+	, m_ModelStarted( false )
+	, m_ModelStart( 0.0 )
+	, m_NumModel( 0 )
+	, m_ModelRing( MODEL_SAMPLES )
+	, m_PosTime( NUM_POSITIONS )
+	, m_PosRing( NUM_POSITIONS )
+	, m_NumPos( 0 )
+	, m_NextPos( 0 )
+	, m_LastEstimate( 0.0 )
+	, m_Detected( WINDOW )
+{}
+
+//===================================================================================
+void LatencyEstimator::SetLatency( const float ms )
+{
+	m_Latency = ms;
+	m_NumEstimates = 0;
+} // SetLatency
+
+//===================================================================================
+void LatencyEstimator::SetAccel( const cv::Point2f& accel )
+{
+	m_Accel = accel;
+} // SetAccel
+
+//===================================================================================
+void LatencyEstimator::Reset()
+{
+	m_ModelStarted = false;
+	m_NumModel = 0;
+	m_NumPos = 0;
+	m_NextPos = 0;
+} // Reset
+
+//===================================================================================
+void LatencyEstimator::AddCommand( const double time, const cv::Point& pos, const cv::Point2f& maxSpeed )
+{
+	if ( !m_ModelStarted )
+	{
+		// starts from where the robot was last seen
+		return;
+	}
+
+	AdvanceModel( time );
+
+	m_Target = cv::Point2f( pos );
+	m_MaxSpeed = maxSpeed;
+} // AddCommand
+
+//===================================================================================
+void LatencyEstimator::AddPosition( const double time, const cv::Point& pos )
+{
+	if ( m_NumPos > 0 && time <= m_PosTime[( m_NextPos + NUM_POSITIONS - 1 ) % NUM_POSITIONS] )
+	{
+		return;
+	}
+
+	m_PosTime[m_NextPos] = time;
+	m_PosRing[m_NextPos] = cv::Point2f( pos );
+	m_NextPos = ( m_NextPos + 1 ) % NUM_POSITIONS;
+	m_NumPos = std::min( m_NumPos + 1, NUM_POSITIONS );
+
+	if ( !m_ModelStarted )
+	{
+		// at rest where it is, until the first command
+		m_ModelStarted = true;
+		m_ModelStart = time;
+		m_NumModel = 0;
+		m_ModelPos = cv::Point2f( pos );
+		m_ModelSpeed = cv::Point2f( 0.0f, 0.0f );
+		m_Target = m_ModelPos;
+		m_MaxSpeed = cv::Point2f( 0.0f, 0.0f );
+		m_LastEstimate = time;
+	}
+
+	AdvanceModel( time );
+
+	if ( time - m_LastEstimate >= ESTIMATE_INTERVAL )
+	{
+		m_LastEstimate = time;
+		Estimate( time );
+	}
+} // AddPosition
+
+//===================================================================================
+// one axis of the model: towards target, braking in time to stop on it
+static void MoveAxis( float& pos, float& speed, const float target, const float maxSpeed, const float accel )
+{
+	const float dt = static_cast<float>( STEP );
+	const float d = target - pos;
+
+	const float stopSpeed = std::sqrt( 2.0f * accel * std::abs( d ) );
+	const float want = ( d < 0.0f ? -1.0f : 1.0f ) * std::min( maxSpeed, stopSpeed );
+
+	const float dv = accel * dt;
+	speed += std::max( -dv, std::min( dv, want - speed ) );
+
+	const float next = pos + speed * dt;
+	if ( ( target - next ) * d <= 0.0f && std::abs( speed ) <= dv )
+	{
+		// arrived
+		pos = target;
+		speed = 0.0f;
+	}
+	else
+	{
+		pos = next;
+	}
+} // MoveAxis
+
+//===================================================================================
+void LatencyEstimator::AdvanceModel( const double time )
+{
+	while ( m_ModelStart + m_NumModel * STEP <= time )
+	{
+		m_ModelRing[m_NumModel % MODEL_SAMPLES] = m_ModelPos;
+		m_NumModel++;
+
+		MoveAxis( m_ModelPos.x, m_ModelSpeed.x, m_Target.x, m_MaxSpeed.x, m_Accel.x );
+		MoveAxis( m_ModelPos.y, m_ModelSpeed.y, m_Target.y, m_MaxSpeed.y, m_Accel.y );
+	}
+} // AdvanceModel
+
+//===================================================================================
+bool LatencyEstimator::GetPosition( const double time, cv::Point2f& pos ) const
+{
+	// newest first, the window is at the end
+	int next = ( m_NextPos + NUM_POSITIONS - 1 ) % NUM_POSITIONS;
+	for ( int i = 1; i < m_NumPos; i++ )
+	{
+		const int prev = ( next + NUM_POSITIONS - 1 ) % NUM_POSITIONS;
+
+		if ( m_PosTime[prev] <= time )
+		{
+			const double gap = m_PosTime[next] - m_PosTime[prev];
+			if ( gap > MAX_GAP || time > m_PosTime[next] )
+			{
+				return false;
+			}
+
+			const float w = static_cast<float>( ( time - m_PosTime[prev] ) / gap );
+			pos = m_PosRing[prev] + ( m_PosRing[next] - m_PosRing[prev] ) * w;
+			return true;
+		}
+
+		next = prev;
+	}
+
+	return false;
+} // GetPosition
+
+//===================================================================================
+void LatencyEstimator::Estimate( const double time )
+{
+	// the window ends on the last detection, the model reaches MAX_LAG before it
+	const long end = std::min( m_NumModel - 1, static_cast<long>( ( time - m_ModelStart ) / STEP ) );
+	const long start = end - WINDOW + 1;
+	if ( start - MAX_LAG < 0 || m_NumModel - ( start - MAX_LAG ) > MODEL_SAMPLES )
+	{
+		return;
+	}
+
+	cv::Point2f detectedMean( 0.0f, 0.0f );
+	for ( int i = 0; i < WINDOW; i++ )
+	{
+		if ( !GetPosition( m_ModelStart + ( start + i ) * STEP, m_Detected[i] ) )
+		{
+			return;
+		}
+
+		detectedMean += m_Detected[i];
+	}
+
+	detectedMean *= 1.0f / WINDOW;
+
+	float detectedVar = 0.0f;
+	for ( int i = 0; i < WINDOW; i++ )
+	{
+		const cv::Point2f d = m_Detected[i] - detectedMean;
+		detectedVar += d.dot( d );
+	}
+
+	// correlation at every lag: the detected position against the model lag samples before
+	float corr[MAX_LAG + 1];
+	float modelVarAtBest = 0.0f;
+	int best = -1;
+
+	for ( int lag = 0; lag <= MAX_LAG; lag++ )
+	{
+		cv::Point2f modelMean( 0.0f, 0.0f );
+		for ( int i = 0; i < WINDOW; i++ )
+		{
+			modelMean += m_ModelRing[( start + i - lag ) % MODEL_SAMPLES];
+		}
+
+		modelMean *= 1.0f / WINDOW;
+
+		float cov = 0.0f;
+		float modelVar = 0.0f;
+		for ( int i = 0; i < WINDOW; i++ )
+		{
+			const cv::Point2f m = m_ModelRing[( start + i - lag ) % MODEL_SAMPLES] - modelMean;
+			cov += m.dot( m_Detected[i] - detectedMean );
+			modelVar += m.dot( m );
+		}
+
+		corr[lag] = modelVar > 0.0f && detectedVar > 0.0f ?
+			cov / std::sqrt( modelVar * detectedVar ) : 0.0f;
+
+		if ( best < 0 || corr[lag] > corr[best] )
+		{
+			best = lag;
+			modelVarAtBest = modelVar;
+		}
+	}
+
+	// the robot has to move, and the peak must be inside the lags, not at their ends
+	if ( modelVarAtBest < MIN_MOVE * MIN_MOVE * WINDOW ||
+		corr[best] < MIN_CORRELATION ||
+		best == 0 || best == MAX_LAG )
+	{
+		return;
+	}
+
+	// parabola through the peak and its neighbours
+	const float denom = corr[best - 1] - 2.0f * corr[best] + corr[best + 1];
+	const float offset = denom < 0.0f ?
+		0.5f * ( corr[best - 1] - corr[best + 1] ) / denom : 0.0f;
+
+	const float latency = ( best + offset ) * static_cast<float>( STEP );
+
+	m_Latency += GAIN * ( latency - m_Latency );
+	m_NumEstimates++;
+} // Estimate
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+//===================================================================================
+// Online estimate of the end-to-end latency: from the capture of the frame a command
+// was decided on, to the robot moving on it as seen by the camera (processing, serial
+// port, firmware, and the camera itself).
+// - The commands drive a model of the robot: per axis, it moves to the commanded
+//   position as fast as the speed and acceleration limits let it. Sampled every STEP ms.
+// - The detected robot positions are resampled on the same grid, over a sliding window.
+// - The lag where the normalized cross-correlation of the two peaks is the latency.
+//   It's only taken when the robot moved enough and the peak is clear, and smoothed
+//   over several windows: until then, the initial value stays.
+//===================================================================================
+class LatencyEstimator
+{
+public:
+	LatencyEstimator();
+
+	// ms, used until the first estimate
+	void SetLatency( const float ms );
+
+	// mm/ms^2, the robot's acceleration limits
+	void SetAccel( const cv::Point2f& accel );
+
+	// start over: no commands, no positions
+	void Reset();
+
+	// time: capture time of the frame the command was decided on (ms)
+	// pos: commanded position (mm). maxSpeed: commanded speed limits (mm/ms)
+	void AddCommand( const double time, const cv::Point& pos, const cv::Point2f& maxSpeed );
+
+	// time: when the robot was seen (ms, see FrameInfo). pos: detected position (mm)
+	void AddPosition( const double time, const cv::Point& pos );
+
+	// ms
+	float GetLatency() const
+	{
+		return m_Latency;
+	}
+
+	// how many windows the latency was estimated from
+	int GetNumEstimates() const
+	{
+		return m_NumEstimates;
+	}
+
+private:
+
+	// move the model on to time, sampling it
+	void AdvanceModel( const double time );
+
+	// cross-correlate the window up to time (ms)
+	void Estimate( const double time );
+
+	// detected position at time, interpolated. false: not seen around then
+	bool GetPosition( const double time, cv::Point2f& pos ) const;
+
+	float					m_Latency;			// ms
+	int						m_NumEstimates;
+	cv::Point2f				m_Accel;			// mm/ms^2
+
+	// model of the commanded motion
+	bool					m_ModelStarted;
+	double					m_ModelStart;		// time of sample 0, ms
+	long					m_NumModel;			// samples so far
+	cv::Point2f				m_ModelPos;			// mm
+	cv::Point2f				m_ModelSpeed;		// mm/ms
+	cv::Point2f				m_Target;			// mm
+	cv::Point2f				m_MaxSpeed;			// mm/ms
+	std::vector<cv::Point2f> m_ModelRing;		// the latest samples
+
+	// detected positions
+	std::vector<double>		m_PosTime;			// ring, ms
+	std::vector<cv::Point2f> m_PosRing;			// ring, mm
+	int						m_NumPos;			// valid entries
+	int						m_NextPos;			// slot of the next one
+	double					m_LastEstimate;		// time of the last window, ms
+
+	// per window, allocated once
+	std::vector<cv::Point2f> m_Detected;
+}; // LatencyEstimator
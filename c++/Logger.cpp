@@ -15,16 +15,18 @@ void Logger::WriteTableCorners(
 	const cv::Point& LowerLeft,
 	const cv::Point& LowerRight ) const
 {
-	std::ofstream logFile;
+	std::ofstream& logFile = m_LogFile;
 
+	if ( logFile.is_open() )
+	{
+		logFile.close();
+	}
 	logFile.open( "Log.txt", std::ios_base::out ); // fresh file
 	logFile << "Table corners: \n";
 	logFile << TopLeft.x << " " << TopLeft.y << std::endl;
 	logFile << TopRight.x << " " << TopRight.y << std::endl;
 	logFile << LowerLeft.x << " " << LowerLeft.y << std::endl;
 	logFile << LowerRight.x << " " << LowerRight.y << std::endl;
-
-	logFile.close();
 }//WriteTableCorners
 
 //============================================================================
@@ -48,13 +50,17 @@ void Logger::LogStatus(
 	const int predictStatus,
 	const unsigned int botStatus,
 	const unsigned int attackStatus,
-	const clock_t attackTime,
+	const double attackTime,
 	const cv::Point2f& avgPuckSpeed,
     const bool correctMissingSteps,
 	const bool bailOut ) const
 {
-	std::ofstream logFile;
-	logFile.open( "Log.txt", std::ios_base::app ); // append
+	std::ofstream& logFile = m_LogFile;
+
+	if ( !logFile.is_open() )
+	{
+		logFile.open( "Log.txt", std::ios_base::app ); // append
+	}
 	logFile << "frame number: \n";
 	logFile << numFrame << std::endl;
 	logFile << "frame time: \n";
@@ -114,6 +120,4 @@ void Logger::LogStatus(
 	{
 		logFile << "no" << std::endl;
 	}
-
-	logFile.close();
 } // LogStatus
\ No newline at end of file
@@ -2,7 +2,8 @@
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
-#include <time.h>
+
+#include <fstream>
 
 class Logger
 {
@@ -37,11 +38,13 @@ public:
 		const int predictStatus,
 		const unsigned int botStatus,
 		const unsigned int attackStatus,
-		const clock_t attackTime,
+		const double attackTime,
 		const cv::Point2f& avgPuckSpeed,
         const bool correctMissingSteps,
 		const bool bailOut ) const;
 
 private:
 
+	// Log.txt, kept open: opening it every frame allocates
+	mutable std::ofstream m_LogFile;
 }; // Logger
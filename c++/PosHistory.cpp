@@ -0,0 +1,130 @@
+#include "PosHistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+//===================================================================================
+PosHistory::PosHistory()
+	: m_Capacity( 0 )
+	, m_Size( 0 )
+	, m_Next( 0 )
+	, m_Segment( 0 )
+	, m_FitSamples( 8 )
+	, m_FitSpan( 100.0 )
+	, m_Tau( 50.0f )
+{
+	SetCapacity( 32 );
+}
+
+//===================================================================================
+void PosHistory::SetCapacity( const int n )
+{
+	m_Capacity = std::max( n, 1 );
+	m_Time.assign( m_Capacity, 0.0 );
+	m_X.assign( m_Capacity, 0.0f );
+	m_Y.assign( m_Capacity, 0.0f );
+
+	Clear();
+} // SetCapacity
+
+//===================================================================================
+void PosHistory::SetWindow( const int samples, const double span )
+{
+	m_FitSamples = samples;
+	m_FitSpan = span;
+} // SetWindow
+
+//===================================================================================
+void PosHistory::SetWeightTau( const float tau )
+{
+	m_Tau = tau;
+} // SetWeightTau
+
+//===================================================================================
+void PosHistory::Clear()
+{
+	m_Size = 0;
+	m_Next = 0;
+	m_Segment = 0;
+} // Clear
+
+//===================================================================================
+void PosHistory::Add( const double time, const cv::Point2f& pos )
+{
+	// overwrite the oldest once full
+	m_Time[m_Next] = time;
+	m_X[m_Next] = pos.x;
+	m_Y[m_Next] = pos.y;
+	m_Next = ( m_Next + 1 ) % m_Capacity;
+
+	m_Size = std::min( m_Size + 1, m_Capacity );
+	m_Segment = std::min( m_Segment + 1, m_Capacity );
+} // Add
+
+//===================================================================================
+void PosHistory::Split()
+{
+	m_Segment = std::min( m_Segment, 1 );
+} // Split
+
+//===================================================================================
+void PosHistory::Restart()
+{
+	m_Segment = 0;
+} // Restart
+
+//===================================================================================
+bool PosHistory::Fit( cv::Point2f& pos, cv::Point2f& speed ) const
+{
+	const int last = Slot( 0 );
+	const double t0 = m_Time[last];
+
+	// weighted sums of the powers of t ( t <= 0 at the newest ), and of x, y times them
+	double s[3] = { 0.0, 0.0, 0.0 };
+	double sx[2] = { 0.0, 0.0 };
+	double sy[2] = { 0.0, 0.0 };
+
+	int n = 0;
+	const int maxN = std::min( std::min( m_Segment, m_Size ), m_FitSamples );
+
+	for ( ; n < maxN; n++ )
+	{
+		const int k = Slot( n );
+		const double t = m_Time[k] - t0;
+		if ( -t > m_FitSpan )
+		{
+			break;
+		}
+
+		const double w = m_Tau > 0.0f ? std::exp( t / m_Tau ) : 1.0;
+
+		s[0] += w;
+		s[1] += w * t;
+		s[2] += w * t * t;
+
+		sx[0] += w * m_X[k];
+		sx[1] += w * t * m_X[k];
+
+		sy[0] += w * m_Y[k];
+		sy[1] += w * t * m_Y[k];
+	}
+
+	if ( n < 2 )
+	{
+		return false;
+	}
+
+	// x = a + b t: the position and the speed
+	const double det = s[0] * s[2] - s[1] * s[1];
+	if ( det <= 0.0 )
+	{
+		return false;
+	}
+
+	pos.x = static_cast<float>( ( s[2] * sx[0] - s[1] * sx[1] ) / det );
+	pos.y = static_cast<float>( ( s[2] * sy[0] - s[1] * sy[1] ) / det );
+	speed.x = static_cast<float>( ( s[0] * sx[1] - s[1] * sx[0] ) / det );
+	speed.y = static_cast<float>( ( s[0] * sy[1] - s[1] * sy[0] ) / det );
+
+	return true;
+} // Fit
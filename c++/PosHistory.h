@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+//===================================================================================
+// The latest timestamped positions of a disk (sub-mm, table coordinate), and its
+// speed fitted on them.
+// - A fixed capacity ring, stored as one array per field: a fit only walks the
+//   times, the x and the y, each contiguous.
+// - Fit() is a weighted least-squares line per axis, over the last
+//   samples within a time span; a sample weighs less the older it is. Many samples of
+//   a high frame rate average the truncation and detection noise out, instead of
+//   dividing it by a shorter time between two frames.
+// - Split() starts a new segment (a bounce, a hit): the fit doesn't reach back across it.
+//===================================================================================
+class PosHistory
+{
+public:
+	PosHistory();
+
+	// the storage is allocated here, not per sample. Clears the history
+	void SetCapacity( const int n );
+
+	// samples: at most this many are fitted. span: ms, nor older than this
+	void SetWindow( const int samples, const double span );
+
+	// ms, a sample this old weighs 1 / e of the newest
+	void SetWeightTau( const float tau );
+
+	void Clear();
+
+	// time: ms. pos: mm
+	void Add( const double time, const cv::Point2f& pos );
+
+	// the newest sample starts a new segment
+	void Split();
+
+	// the next sample starts a new segment, the newest isn't in it
+	void Restart();
+
+	// number of samples, in all segments
+	int GetSize() const
+	{
+		return m_Size;
+	}
+
+	// i = 0: the newest
+	double GetTime( const int i ) const
+	{
+		return m_Time[Slot( i )];
+	}
+
+	cv::Point2f GetPos( const int i ) const
+	{
+		return cv::Point2f( m_X[Slot( i )], m_Y[Slot( i )] );
+	}
+
+	// position and speed (mm/ms): the weighted line, they're as of a little before the
+	// newest sample. No acceleration: between the bounces and hits that split the
+	// segments, the puck's is below what a short window can tell from the noise.
+	// @return false: fewer than 2 samples in the segment and the window
+	bool Fit( cv::Point2f& pos, cv::Point2f& speed ) const;
+
+private:
+
+	int Slot( const int i ) const
+	{
+		return ( m_Next - 1 - i + m_Capacity ) % m_Capacity;
+	}
+
+	std::vector<double>	m_Time;		// ms
+	std::vector<float>	m_X;		// mm
+	std::vector<float>	m_Y;		// mm
+	int					m_Capacity;
+	int					m_Size;		// valid samples
+	int					m_Next;		// slot of the next sample
+	int					m_Segment;	// samples in the current segment
+
+	int					m_FitSamples;
+	double				m_FitSpan;	// ms
+	float				m_Tau;		// ms
+}; // PosHistory
@@ -0,0 +1,194 @@
+#include "PuckFilter.h"
+
+#include <cfloat>
+#include <cmath>
+
+#define ACCEL_STD		0.005f	// mm/ms^2 (5 m/s^2): friction, spin, a slightly tilted table
+#define MEAS_STD		3.0f	// mm, about a pixel
+#define INNOVATION_GATE	16.0f	// normalized innovation squared (chi-square, 2 dof) above which it's a hit
+
+//===================================================================================
+PuckFilter::PuckFilter()
+	: m_State( cv::Matx41f::zeros() )
+	, m_Cov( cv::Matx44f::eye() )
+	, m_Left( -FLT_MAX )
+	, m_Right( FLT_MAX )
+	, m_AccelVar( ACCEL_STD * ACCEL_STD )
+	, m_MeasVar( MEAS_STD * MEAS_STD )
+	, m_Initialized( false )
+	, m_Bounced( false )
+	, m_Maneuvered( false )
+	, m_SinceLastMeas( 0.0f )
+{}
+
+//===================================================================================
+void PuckFilter::SetWalls( const float left, const float right )
+{
+	m_Left = left;
+	m_Right = right;
+} // SetWalls
+
+//===================================================================================
+void PuckFilter::SetNoise( const float accel, const float measurement )
+{
+	m_AccelVar = accel * accel;
+	m_MeasVar = measurement * measurement;
+} // SetNoise
+
+//===================================================================================
+void PuckFilter::Clear()
+{
+	m_Initialized = false;
+	m_Bounced = false;
+	m_Maneuvered = false;
+} // Clear
+
+//===================================================================================
+void PuckFilter::Reset( const cv::Point2f& pos, const cv::Point2f& speed, const float speedStd )
+{
+	m_State = cv::Matx41f( pos.x, pos.y, speed.x, speed.y );
+
+	m_Cov = cv::Matx44f::zeros();
+	m_Cov( 0, 0 ) = m_Cov( 1, 1 ) = m_MeasVar;
+	m_Cov( 2, 2 ) = m_Cov( 3, 3 ) = speedStd * speedStd;
+
+	m_LastMeas = pos;
+	m_SinceLastMeas = 0.0f;
+	m_Initialized = true;
+	m_Bounced = false;
+} // Reset
+
+//===================================================================================
+bool PuckFilter::Reflect( float& x, float& vx ) const
+{
+	bool reflected = false;
+
+	// a fast puck in a long dt may hit both walls
+	for ( int i = 0; i < 4; i++ )
+	{
+		if ( x < m_Left )
+		{
+			x = 2.0f * m_Left - x;
+		}
+		else if ( x > m_Right )
+		{
+			x = 2.0f * m_Right - x;
+		}
+		else
+		{
+			break;
+		}
+
+		vx = -vx;
+		reflected = true;
+	}
+
+	return reflected;
+} // Reflect
+
+//===================================================================================
+void PuckFilter::Predict( const float dt )
+{
+	cv::Matx44f F = cv::Matx44f::eye();
+	F( 0, 2 ) = dt;
+	F( 1, 3 ) = dt;
+
+	// white noise acceleration, per axis: [ dt^4 / 4, dt^3 / 2; dt^3 / 2, dt^2 ] * var
+	const float dt2 = dt * dt;
+	cv::Matx44f Q = cv::Matx44f::zeros();
+	Q( 0, 0 ) = Q( 1, 1 ) = 0.25f * dt2 * dt2 * m_AccelVar;
+	Q( 0, 2 ) = Q( 2, 0 ) = Q( 1, 3 ) = Q( 3, 1 ) = 0.5f * dt2 * dt * m_AccelVar;
+	Q( 2, 2 ) = Q( 3, 3 ) = dt2 * m_AccelVar;
+
+	m_State = F * m_State;
+	m_Cov = F * m_Cov * F.t() + Q;
+
+	m_Bounced = Reflect( m_State( 0 ), m_State( 2 ) );
+
+	if ( m_Bounced )
+	{
+		// x and vx are mirrored: their covariances with y and vy change sign
+		const cv::Matx44f J(
+			-1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, -1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f );
+
+		m_Cov = J * m_Cov * J;
+	}
+
+	m_SinceLastMeas += dt;
+} // Predict
+
+//===================================================================================
+void PuckFilter::Correct( const cv::Point2f& pos )
+{
+	// innovation and its covariance S = H P H^t + R, H picks x and y
+	const float yx = pos.x - m_State( 0 );
+	const float yy = pos.y - m_State( 1 );
+
+	const float s00 = m_Cov( 0, 0 ) + m_MeasVar;
+	const float s01 = m_Cov( 0, 1 );
+	const float s11 = m_Cov( 1, 1 ) + m_MeasVar;
+	const float det = s00 * s11 - s01 * s01;
+
+	const cv::Matx22f Sinv( s11 / det, -s01 / det, -s01 / det, s00 / det );
+
+	const float nis = yx * ( Sinv( 0, 0 ) * yx + Sinv( 0, 1 ) * yy ) + yy * ( Sinv( 1, 0 ) * yx + Sinv( 1, 1 ) * yy );
+
+	m_Maneuvered = nis > INNOVATION_GATE && m_SinceLastMeas > 0.0f;
+
+	if ( m_Maneuvered )
+	{
+		// hit: the speed since the last measurement, as uncertain as two positions make it
+		const cv::Point2f speed = ( pos - m_LastMeas ) / m_SinceLastMeas;
+		const float speedStd = 2.0f * std::sqrt( m_MeasVar ) / m_SinceLastMeas;
+
+		Reset( pos, speed, speedStd );
+		return;
+	}
+
+	// gain K = P H^t S^-1
+	cv::Matx<float, 4, 2> PHt;
+	for ( int i = 0; i < 4; i++ )
+	{
+		PHt( i, 0 ) = m_Cov( i, 0 );
+		PHt( i, 1 ) = m_Cov( i, 1 );
+	}
+
+	const cv::Matx<float, 4, 2> K = PHt * Sinv;
+
+	m_State = m_State + K * cv::Matx21f( yx, yy );
+
+	// P = ( I - K H ) P
+	cv::Matx44f KH = cv::Matx44f::zeros();
+	for ( int i = 0; i < 4; i++ )
+	{
+		KH( i, 0 ) = K( i, 0 );
+		KH( i, 1 ) = K( i, 1 );
+	}
+
+	m_Cov = ( cv::Matx44f::eye() - KH ) * m_Cov;
+
+	// keep it symmetric against rounding
+	m_Cov = ( m_Cov + m_Cov.t() ) * 0.5f;
+
+	m_LastMeas = pos;
+	m_SinceLastMeas = 0.0f;
+} // Correct
+
+//===================================================================================
+cv::Point2f PuckFilter::Extrapolate( const float t ) const
+{
+	float x = m_State( 0 ) + m_State( 2 ) * t;
+	float vx = m_State( 2 );
+	Reflect( x, vx );
+
+	return cv::Point2f( x, m_State( 1 ) + m_State( 3 ) * t );
+} // Extrapolate
+
+//===================================================================================
+float PuckFilter::GetStdX( const float t ) const
+{
+	return std::sqrt( m_Cov( 0, 0 ) + 2.0f * t * m_Cov( 0, 2 ) + t * t * m_Cov( 2, 2 ) );
+} // GetStdX
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+//===================================================================================
+// Constant velocity Kalman filter of the puck, in table coordinate.
+// State: x, y (mm), vx, vy (mm/ms); covariance P of the state.
+// - Predict() moves the state by the real time since the last measurement. The puck
+//   bounces off the side walls: a move past a wall is reflected, and P with it.
+// - Correct() blends in a measured position. A measurement too far off the prediction
+//   (normalized innovation over the gate) is a hit, not noise: the speed is taken from
+//   the last two measurements instead of being blended in over several frames.
+//===================================================================================
+class PuckFilter
+{
+public:
+	PuckFilter();
+
+	// x range of the puck's center between the side walls
+	void SetWalls( const float left, const float right );
+
+	// accel: std of the acceleration, mm/ms^2. measurement: std of a position, mm
+	void SetNoise( const float accel, const float measurement );
+
+	// no state, the next measurement starts over
+	void Clear();
+
+	bool IsInitialized() const
+	{
+		return m_Initialized;
+	}
+
+	// start from a position, with speed known to speedStd (mm/ms)
+	void Reset( const cv::Point2f& pos, const cv::Point2f& speed, const float speedStd );
+
+	// dt: ms since the last state
+	void Predict( const float dt );
+
+	// pos: measured, mm
+	void Correct( const cv::Point2f& pos );
+
+	cv::Point2f GetPos() const
+	{
+		return cv::Point2f( m_State( 0 ), m_State( 1 ) );
+	}
+
+	// mm/ms
+	cv::Point2f GetSpeed() const
+	{
+		return cv::Point2f( m_State( 2 ), m_State( 3 ) );
+	}
+
+	// covariance of x, y, vx, vy
+	const cv::Matx44f& GetCovariance() const
+	{
+		return m_Cov;
+	}
+
+	// the last Predict() bounced off a wall
+	bool HasBounced() const
+	{
+		return m_Bounced;
+	}
+
+	// the last Correct() found a hit, the speed is from two measurements only
+	bool HasManeuvered() const
+	{
+		return m_Maneuvered;
+	}
+
+	// where the puck will be in t ms, bouncing off the walls
+	cv::Point2f Extrapolate( const float t ) const;
+
+	// std of x in t ms (mm), e.g. how far off a predicted impact may be
+	float GetStdX( const float t ) const;
+
+private:
+
+	// mirror x into the walls. true if it was past one
+	bool Reflect( float& x, float& vx ) const;
+
+	cv::Matx41f		m_State;
+	cv::Matx44f		m_Cov;
+	float			m_Left;
+	float			m_Right;
+	float			m_AccelVar;		// mm^2/ms^4
+	float			m_MeasVar;		// mm^2
+	bool			m_Initialized;
+	bool			m_Bounced;
+	bool			m_Maneuvered;
+	cv::Point2f		m_LastMeas;		// last measured position
+	float			m_SinceLastMeas;// ms
+}; // PuckFilter
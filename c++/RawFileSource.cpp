@@ -0,0 +1,95 @@
+#include "RawFileSource.h"
+
+//=======================================================================
+RawFileSource::RawFileSource()
+	: m_Pos( 0 )
+{}
+
+//=======================================================================
+bool RawFileSource::Open( const std::string& filename )
+{
+	Close();
+
+	return m_Reader.Open( filename );
+}
+
+//=======================================================================
+void RawFileSource::Close()
+{
+	m_Reader.Close();
+	m_Pos = 0;
+}
+
+//=======================================================================
+bool RawFileSource::Grab( cv::Mat& frame, FrameInfo& info )
+{
+	if ( !m_Reader.GetFrame( m_Pos, frame, info ) )
+	{
+		return false;
+	}
+
+	// time stamp from the recording, relative to its first frame like CAP_PROP_POS_MSEC
+	info.m_SourceTime = info.m_CaptureTime - m_Reader.GetCaptureTime( 0 );
+	info.m_CaptureTime = FrameInfo::Now();
+
+	m_Pos++;
+
+	return true;
+} // Grab
+
+//=======================================================================
+double RawFileSource::GetPositionMS()
+{
+	return m_Reader.GetCaptureTime( m_Pos ) - m_Reader.GetCaptureTime( 0 );
+}
+
+//=======================================================================
+double RawFileSource::GetFrameRate()
+{
+	const long n = m_Reader.GetNumFrames();
+	const double duration = m_Reader.GetCaptureTime( n - 1 ) - m_Reader.GetCaptureTime( 0 );
+
+	return duration > 0.0 ? ( n - 1 ) * 1000.0 / duration : 0.0;
+}
+
+//=======================================================================
+bool RawFileSource::SetFrameNumber( long pos )
+{
+	if ( pos < 0 || pos > m_Reader.GetNumFrames() )
+	{
+		return false;
+	}
+
+	m_Pos = pos;
+	return true;
+}
+
+//=======================================================================
+bool RawFileSource::SetPositionMS( double pos )
+{
+	const long n = m_Reader.GetNumFrames();
+	const double t0 = m_Reader.GetCaptureTime( 0 );
+
+	long i = 0;
+	while ( i < n && m_Reader.GetCaptureTime( i ) - t0 < pos )
+	{
+		i++;
+	}
+
+	m_Pos = i;
+	return i < n;
+} // SetPositionMS
+
+//=======================================================================
+bool RawFileSource::SetRelativePosition( double pos )
+{
+	const long i = static_cast<long>( pos * m_Reader.GetNumFrames() + 0.5 );
+
+	if ( i < 0 || i >= m_Reader.GetNumFrames() )
+	{
+		return false;
+	}
+
+	m_Pos = i;
+	return true;
+}
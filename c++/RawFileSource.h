@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+
+#include "FrameSource.h"
+#include "RawFrameReader.h"
+
+//===================================================================================
+// Frames from a memory-mapped raw recording (see RawFrameFile.h), without copying
+//===================================================================================
+class RawFileSource : public FrameSource
+{
+public:
+	RawFileSource();
+
+	bool Open( const std::string& filename );
+
+	bool IsOpened() const override
+	{
+		return m_Reader.IsOpened();
+	}
+
+	void Close() override;
+
+	bool Grab( cv::Mat& frame, FrameInfo& info ) override;
+
+	cv::Size GetFrameSize() override
+	{
+		return m_Reader.GetFrameSize();
+	}
+
+	PIXEL_FORMAT GetPixelFormat() const override
+	{
+		return m_Reader.GetFormat() == RawFrameFile::YUYV ? YUYV : BGR;
+	}
+
+	// frames point into the (copy-on-write) mapping
+	bool IsZeroCopy() const override
+	{
+		return true;
+	}
+
+	long GetFrameNumber() override
+	{
+		return m_Pos;
+	}
+
+	long GetTotalFrameCount() override
+	{
+		return m_Reader.GetNumFrames();
+	}
+
+	// recorded time of the next frame, relative to the first one
+	double GetPositionMS() override;
+
+	// average over the recording, 0 if it has no time stamps
+	double GetFrameRate() override;
+
+	bool SetFrameNumber( long pos ) override;
+
+	// first frame recorded at or after pos
+	bool SetPositionMS( double pos ) override;
+
+	bool SetRelativePosition( double pos ) override;
+
+private:
+	RawFrameReader	m_Reader;
+	long			m_Pos;		// position of the next frame
+}; // RawFileSource
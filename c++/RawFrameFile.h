@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+//===================================================================================
+// Layout of a raw frame recording (*.raw), shared by RawFrameWriter and RawFrameReader.
+//
+//   [RawFileHeader, padded to m_DataOffset]
+//   [frame 0][frame 1] ... [frame n-1]     each m_FrameBytes of pixels, padded to m_FrameStride
+//   [RawFrameRecord x n]                   index of the frames' time stamps, at m_IndexOffset
+//
+// Frames start on page boundaries, so a memory-mapped frame can be used as is.
+// The header is written again with m_NumFrames and m_IndexOffset when the recording
+// is closed; a recording that wasn't closed has m_NumFrames = 0 and no index.
+//===================================================================================
+namespace RawFrameFile
+{
+	enum FORMAT { BGR = 0, YUYV }; // pixel format: 3 bytes/pixel, or 2 bytes/pixel (4:2:2)
+
+	const char		MAGIC[8]	= { 'A', 'I', 'D', 'N', 'R', 'A', 'W', '1' };
+	const uint32_t	VERSION		= 1;
+	const uint32_t	ALIGNMENT	= 4096; // page size
+
+	struct RawFileHeader
+	{
+		char		m_Magic[8];
+		uint32_t	m_Version;
+		uint32_t	m_Format;		// FORMAT
+		int32_t		m_Width;
+		int32_t		m_Height;
+		uint32_t	m_FrameBytes;	// size of one frame's pixels
+		uint32_t	m_FrameStride;	// distance between 2 frames in the file
+		uint64_t	m_DataOffset;	// where frame 0 starts
+		uint64_t	m_NumFrames;
+		uint64_t	m_IndexOffset;	// where the RawFrameRecords start
+		uint64_t	m_Reserved;
+	};
+
+	struct RawFrameRecord
+	{
+		int64_t		m_Index;		// FrameInfo::m_Index when recorded
+		double		m_CaptureTime;	// FrameInfo::m_CaptureTime when recorded (ms)
+	};
+
+	static_assert( sizeof( RawFileHeader ) == 64, "RawFileHeader must stay 64 bytes" );
+	static_assert( sizeof( RawFrameRecord ) == 16, "RawFrameRecord must stay 16 bytes" );
+
+	// round n up to a multiple of ALIGNMENT
+	inline uint64_t Align( const uint64_t n )
+	{
+		return ( n + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+	}
+} // RawFrameFile
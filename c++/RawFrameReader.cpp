@@ -0,0 +1,205 @@
+#include "RawFrameReader.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//=======================================================================
+RawFrameReader::RawFrameReader()
+	: m_Records( NULL )
+	, m_Base( NULL )
+	, m_Size( 0 )
+#ifdef _WIN32
+	, m_File( INVALID_HANDLE_VALUE )
+	, m_Mapping( NULL )
+#else
+	, m_Fd( -1 )
+#endif
+{
+	std::memset( &m_Header, 0, sizeof( m_Header ) );
+}
+
+//=======================================================================
+RawFrameReader::~RawFrameReader()
+{
+	Close();
+}
+
+//=======================================================================
+bool RawFrameReader::Open( const std::string& filename )
+{
+	Close();
+
+	//////////////////////////////////
+	// map the whole file, copy-on-write
+	//////////////////////////////////
+#ifdef _WIN32
+	m_File = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( m_File == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if ( !GetFileSizeEx( m_File, &size ) )
+	{
+		Close();
+		return false;
+	}
+	m_Size = static_cast<uint64_t>( size.QuadPart );
+
+	m_Mapping = CreateFileMappingA( m_File, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+	if ( m_Mapping == NULL )
+	{
+		Close();
+		return false;
+	}
+
+	m_Base = static_cast<uint8_t*>( MapViewOfFile( m_Mapping, FILE_MAP_COPY, 0, 0, 0 ) );
+#else
+	m_Fd = open( filename.c_str(), O_RDONLY );
+	if ( m_Fd < 0 )
+	{
+		return false;
+	}
+
+	struct stat st;
+	if ( fstat( m_Fd, &st ) != 0 || st.st_size == 0 )
+	{
+		Close();
+		return false;
+	}
+	m_Size = static_cast<uint64_t>( st.st_size );
+
+	void* p = mmap( NULL, static_cast<size_t>( m_Size ), PROT_READ | PROT_WRITE, MAP_PRIVATE, m_Fd, 0 );
+	m_Base = p == MAP_FAILED ? NULL : static_cast<uint8_t*>( p );
+#endif
+
+	if ( m_Base == NULL || m_Size < sizeof( m_Header ) )
+	{
+		Close();
+		return false;
+	}
+
+	//////////////////////////////////
+	// check the header
+	//////////////////////////////////
+	std::memcpy( &m_Header, m_Base, sizeof( m_Header ) );
+
+	const uint64_t bytesPerPixel = m_Header.m_Format == RawFrameFile::YUYV ? 2 : 3;
+	const uint64_t pixelBytes = static_cast<uint64_t>( m_Header.m_Width ) * m_Header.m_Height * bytesPerPixel;
+
+	// a frame must hold its pixels, and fit in its stride
+	if ( std::memcmp( m_Header.m_Magic, RawFrameFile::MAGIC, sizeof( m_Header.m_Magic ) ) != 0 ||
+		m_Header.m_Version != RawFrameFile::VERSION ||
+		m_Header.m_Format > RawFrameFile::YUYV ||
+		m_Header.m_Width <= 0 || m_Header.m_Height <= 0 ||
+		m_Header.m_FrameBytes < pixelBytes ||
+		m_Header.m_FrameStride < m_Header.m_FrameBytes ||
+		m_Header.m_DataOffset < sizeof( m_Header ) ||
+		m_Header.m_DataOffset > m_Size )
+	{
+		Close();
+		return false;
+	}
+
+	if ( m_Header.m_NumFrames > 0 && m_Header.m_IndexOffset > 0 )
+	{
+		// the frames end before the index, the index before the end of the file.
+		// Divided rather than multiplied: a bad count mustn't overflow
+		if ( m_Header.m_IndexOffset < m_Header.m_DataOffset ||
+			m_Header.m_IndexOffset > m_Size ||
+			m_Header.m_NumFrames > ( m_Header.m_IndexOffset - m_Header.m_DataOffset ) / m_Header.m_FrameStride ||
+			m_Header.m_NumFrames > ( m_Size - m_Header.m_IndexOffset ) / sizeof( RawFrameFile::RawFrameRecord ) )
+		{
+			Close();
+			return false;
+		}
+
+		m_Records = reinterpret_cast<const RawFrameFile::RawFrameRecord*>( m_Base + m_Header.m_IndexOffset );
+	}
+	else
+	{
+		// the recording wasn't closed: keep the complete frames, without time stamps.
+		// The last one needs its pixels, not its padding
+		const uint64_t data = m_Size - m_Header.m_DataOffset;
+		m_Header.m_NumFrames = data < m_Header.m_FrameBytes ? 0 :
+			( data - m_Header.m_FrameBytes ) / m_Header.m_FrameStride + 1;
+	}
+
+	return true;
+} // Open
+
+//=======================================================================
+void RawFrameReader::Close()
+{
+#ifdef _WIN32
+	if ( m_Base != NULL )
+	{
+		UnmapViewOfFile( m_Base );
+	}
+	if ( m_Mapping != NULL )
+	{
+		CloseHandle( m_Mapping );
+		m_Mapping = NULL;
+	}
+	if ( m_File != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle( m_File );
+		m_File = INVALID_HANDLE_VALUE;
+	}
+#else
+	if ( m_Base != NULL )
+	{
+		munmap( m_Base, static_cast<size_t>( m_Size ) );
+	}
+	if ( m_Fd >= 0 )
+	{
+		close( m_Fd );
+		m_Fd = -1;
+	}
+#endif
+
+	m_Base = NULL;
+	m_Size = 0;
+	m_Records = NULL;
+	std::memset( &m_Header, 0, sizeof( m_Header ) );
+} // Close
+
+//=======================================================================
+bool RawFrameReader::GetFrame( const long i, cv::Mat& frame, FrameInfo& info )
+{
+	if ( m_Base == NULL || i < 0 || i >= GetNumFrames() )
+	{
+		return false;
+	}
+
+	const int type = m_Header.m_Format == RawFrameFile::YUYV ? CV_8UC2 : CV_8UC3;
+	uint8_t* data = m_Base + m_Header.m_DataOffset + static_cast<uint64_t>( i ) * m_Header.m_FrameStride;
+
+	// a header over the mapping, no copy
+	frame = cv::Mat( m_Header.m_Height, m_Header.m_Width, type, data );
+
+	info.m_Index = m_Records != NULL ? static_cast<long>( m_Records[i].m_Index ) : i;
+	info.m_CaptureTime = GetCaptureTime( i );
+
+	return true;
+} // GetFrame
+
+//=======================================================================
+double RawFrameReader::GetCaptureTime( const long i ) const
+{
+	if ( m_Records == NULL || i < 0 || i >= GetNumFrames() )
+	{
+		return 0.0;
+	}
+
+	return m_Records[i].m_CaptureTime;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <cstdint>
+
+#include "RawFrameFile.h"
+#include "FrameInfo.h"
+
+//===================================================================================
+// Replays a raw frame file (see RawFrameFile.h) by memory-mapping it.
+// Frames are handed out as cv::Mat headers over the mapping, nothing is copied.
+// The mapping is copy-on-write: a processor drawing on its input frame only gets
+// private copies of the pages it touches, the file is never modified.
+//===================================================================================
+class RawFrameReader
+{
+public:
+	RawFrameReader();
+
+	~RawFrameReader();
+
+	bool Open( const std::string& filename );
+
+	// frames handed out by GetFrame() are invalid after this
+	void Close();
+
+	bool IsOpened() const
+	{
+		return m_Base != NULL;
+	}
+
+	long GetNumFrames() const
+	{
+		return static_cast<long>( m_Header.m_NumFrames );
+	}
+
+	cv::Size GetFrameSize() const
+	{
+		return cv::Size( m_Header.m_Width, m_Header.m_Height );
+	}
+
+	RawFrameFile::FORMAT GetFormat() const
+	{
+		return static_cast<RawFrameFile::FORMAT>( m_Header.m_Format );
+	}
+
+	// @brief: frame i, as a header over the mapped file (CV_8UC3 for BGR, CV_8UC2 for YUYV)
+	// info: index and capture time recorded with the frame (0 if the recording has no index)
+	bool GetFrame( const long i, cv::Mat& frame, FrameInfo& info );
+
+	// recorded capture time of frame i (ms), 0 if the recording has no index
+	double GetCaptureTime( const long i ) const;
+
+private:
+	RawFrameFile::RawFileHeader		m_Header;
+	const RawFrameFile::RawFrameRecord*	m_Records;	// time stamp index, NULL if none
+	uint8_t*	m_Base;		// start of the mapping
+	uint64_t	m_Size;		// size of the mapping
+
+#ifdef _WIN32
+	void*		m_File;		// HANDLE
+	void*		m_Mapping;	// HANDLE
+#else
+	int			m_Fd;
+#endif
+}; // RawFrameReader
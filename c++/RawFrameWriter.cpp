@@ -0,0 +1,119 @@
+#include "RawFrameWriter.h"
+
+#include <cstring>
+
+//=======================================================================
+RawFrameWriter::RawFrameWriter()
+{
+	std::memset( &m_Header, 0, sizeof( m_Header ) );
+}
+
+//=======================================================================
+RawFrameWriter::~RawFrameWriter()
+{
+	Close();
+}
+
+//=======================================================================
+bool RawFrameWriter::Open( const std::string& filename, const cv::Size& size, const RawFrameFile::FORMAT format )
+{
+	Close();
+
+	if ( size.width <= 0 || size.height <= 0 || ( format == RawFrameFile::YUYV && size.width % 2 != 0 ) )
+	{
+		return false;
+	}
+
+	m_File.open( filename, std::ios::out | std::ios::binary | std::ios::trunc );
+	if ( !m_File.is_open() )
+	{
+		return false;
+	}
+
+	const uint32_t bytesPerPixel = format == RawFrameFile::YUYV ? 2 : 3;
+
+	std::memset( &m_Header, 0, sizeof( m_Header ) );
+	std::memcpy( m_Header.m_Magic, RawFrameFile::MAGIC, sizeof( m_Header.m_Magic ) );
+	m_Header.m_Version		= RawFrameFile::VERSION;
+	m_Header.m_Format		= format;
+	m_Header.m_Width		= size.width;
+	m_Header.m_Height		= size.height;
+	m_Header.m_FrameBytes	= size.width * size.height * bytesPerPixel;
+	m_Header.m_FrameStride	= static_cast<uint32_t>( RawFrameFile::Align( m_Header.m_FrameBytes ) );
+	m_Header.m_DataOffset	= RawFrameFile::Align( sizeof( m_Header ) );
+
+	// the header is written again by Close(), with the frame count and the index offset
+	std::vector<char> headerBlock( static_cast<size_t>( m_Header.m_DataOffset ), 0 );
+	std::memcpy( headerBlock.data(), &m_Header, sizeof( m_Header ) );
+	m_File.write( headerBlock.data(), headerBlock.size() );
+
+	m_Padding.assign( m_Header.m_FrameStride - m_Header.m_FrameBytes, 0 );
+	m_Records.clear();
+	m_Records.reserve( 1 << 16 ); // ~36 min at 30 fps before it has to grow
+
+	return m_File.good();
+} // Open
+
+//=======================================================================
+bool RawFrameWriter::Write( const cv::Mat& frame, const FrameInfo& info )
+{
+	const int type = m_Header.m_Format == RawFrameFile::YUYV ? CV_8UC2 : CV_8UC3;
+
+	if ( !m_File.is_open() || frame.type() != type ||
+		frame.cols != m_Header.m_Width || frame.rows != m_Header.m_Height )
+	{
+		return false;
+	}
+
+	if ( frame.isContinuous() )
+	{
+		m_File.write( reinterpret_cast<const char*>( frame.data ), m_Header.m_FrameBytes );
+	}
+	else
+	{
+		// e.g. a cropped frame
+		const size_t rowBytes = frame.cols * frame.elemSize();
+		for ( int r = 0; r < frame.rows; r++ )
+		{
+			m_File.write( reinterpret_cast<const char*>( frame.ptr( r ) ), rowBytes );
+		}
+	}
+
+	if ( !m_Padding.empty() )
+	{
+		m_File.write( m_Padding.data(), m_Padding.size() );
+	}
+
+	RawFrameFile::RawFrameRecord record;
+	record.m_Index = info.m_Index;
+	record.m_CaptureTime = info.m_CaptureTime;
+	m_Records.push_back( record );
+
+	return m_File.good();
+} // Write
+
+//=======================================================================
+void RawFrameWriter::Close()
+{
+	if ( !m_File.is_open() )
+	{
+		return;
+	}
+
+	// index after the last frame
+	m_Header.m_NumFrames = m_Records.size();
+	m_Header.m_IndexOffset = m_Header.m_DataOffset + m_Header.m_NumFrames * m_Header.m_FrameStride;
+
+	m_File.seekp( static_cast<std::streamoff>( m_Header.m_IndexOffset ) );
+	if ( !m_Records.empty() )
+	{
+		m_File.write( reinterpret_cast<const char*>( m_Records.data() ), m_Records.size() * sizeof( RawFrameFile::RawFrameRecord ) );
+	}
+
+	// patch the header
+	m_File.seekp( 0 );
+	m_File.write( reinterpret_cast<const char*>( &m_Header ), sizeof( m_Header ) );
+
+	m_File.close();
+	m_Records.clear();
+} // Close
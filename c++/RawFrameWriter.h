@@ -0,0 +1,48 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "RawFrameFile.h"
+#include "FrameInfo.h"
+
+//===================================================================================
+// Records frames to a raw frame file (see RawFrameFile.h).
+// Each frame costs one write of its pixels, no encoding.
+//===================================================================================
+class RawFrameWriter
+{
+public:
+	RawFrameWriter();
+
+	// closes the recording
+	~RawFrameWriter();
+
+	// @brief: create the file for frames of the given size and format
+	bool Open( const std::string& filename, const cv::Size& size, const RawFrameFile::FORMAT format );
+
+	bool IsOpened() const
+	{
+		return m_File.is_open();
+	}
+
+	RawFrameFile::FORMAT GetFormat() const
+	{
+		return static_cast<RawFrameFile::FORMAT>( m_Header.m_Format );
+	}
+
+	// @brief: append a frame. Must be CV_8UC3 (BGR) or CV_8UC2 (YUYV), of the size given to Open()
+	bool Write( const cv::Mat& frame, const FrameInfo& info );
+
+	// write the time stamp index and the final header
+	void Close();
+
+private:
+	std::ofstream							m_File;
+	RawFrameFile::RawFileHeader				m_Header;
+	std::vector<RawFrameFile::RawFrameRecord>	m_Records;
+	std::vector<char>						m_Padding; // zeros, from frame end to stride
+}; // RawFrameWriter
@@ -9,7 +9,7 @@
 //====================================================================================================================
 Robot::Robot()
 	: m_RobotStatus( BOT_STATUS::INIT )
-	, m_AttackTime( 0 )
+	, m_AttackTime( 0.0 )
 	, m_AttackStatus( ATTACK_STATUS::WAIT_FOR_ATTACK )
     , m_DesiredYSpeed( 0 )
     , m_DesiredXSpeed( 0 )
@@ -138,6 +138,13 @@ void Robot::NewDataStrategy( Camera& cam )
                 }
             }
             break;
+
+        case Camera::PREDICT_STATUS::MULTI_BOUNCE:
+            {
+                // bank shot: the bounces add up the error, wait for it at the predicted pos
+                m_RobotStatus = BOT_STATUS::DEFENCE;
+            }
+            break;
         default:
             break;
     } // switch
@@ -145,7 +152,7 @@ void Robot::NewDataStrategy( Camera& cam )
 } // Robot::NewDataStrategy
 
 //====================================================================================================================
-bool Robot::RobotMoveDecision( Camera& cam )
+bool Robot::RobotMoveDecision( Camera& cam, const double now )
 {
     bool bailOut = false;
 
@@ -256,7 +263,8 @@ bool Robot::RobotMoveDecision( Camera& cam )
 
 	case BOT_STATUS::DEFENCE_AND_ATTACK:
 	{
-		if ( cam.GetPredictTimeAttack() < MIN_PREDICT_TIME )
+		// x < 0: the puck isn't predicted to cross the attack line
+		if ( cam.GetPredictXAttack() >= 0 && cam.GetPredictTimeAttack() < MIN_PREDICT_TIME )
 		{
             m_DesiredRobotPos.y = ROBOT_DEFENSE_ATTACK_POSITION_DEFAULT + PRE_ATTACK_DIST; // we need some override
             m_DesiredRobotPos.x = cam.GetPredictXAttack();
@@ -284,7 +292,7 @@ bool Robot::RobotMoveDecision( Camera& cam )
                 ( attackPredictPos.y > PUCK_SIZE * 2 ) &&
                 ( attackPredictPos.y < ROBOT_CENTER_Y - PUCK_SIZE * 4 ) )
             {
-                m_AttackTime = clock() + static_cast<clock_t>( ATTACK_TIME_THRESHOLD * CLOCKS_PER_SEC / 1000.0f );  // Prepare an attack in 500ms
+                m_AttackTime = now + ATTACK_TIME_THRESHOLD;  // Prepare an attack in 500ms
 
                                                                                                                     // Go to pre-attack position
                 m_DesiredRobotPos.x = attackPredictPos.x;
@@ -311,7 +319,7 @@ bool Robot::RobotMoveDecision( Camera& cam )
 			if ( m_AttackStatus == ATTACK_STATUS::READY_TO_ATTACK )
 			{
 				// ready to attack
-                const int impactTime = static_cast<int>( ( m_AttackTime - clock() ) * 1000.0f / CLOCKS_PER_SEC ); // in ms
+                const int impactTime = static_cast<int>( m_AttackTime - now ); // in ms
                 if( impactTime < IMPACT_TIME_THRESHOLD )
                 {
                     // Attack movement
@@ -337,7 +345,7 @@ bool Robot::RobotMoveDecision( Camera& cam )
 			if ( m_AttackStatus == ATTACK_STATUS::AFTER_ATTACK )
 			{
 				// after firing attack
-				int dt = static_cast<int>( ( clock() - m_AttackTime ) * 1000.0f / CLOCKS_PER_SEC ); // in ms
+				int dt = static_cast<int>( now - m_AttackTime ); // in ms
 
 				if ( dt > 80 ) // Attack move is done? => Reset to defense position
 				{
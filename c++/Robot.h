@@ -8,7 +8,6 @@
 #include <opencv2/highgui.hpp>
 #include <opencv2/video.hpp>
 #include <opencv2/imgproc.hpp>
-#include <time.h>
 
 #include "Camera.h"
 
@@ -45,7 +44,9 @@ public:
 	//   3: Attack mode
 	//   4: ?? REMOVE ??
 	//   5: Manual mode => User send direct commands to robot
-	bool RobotMoveDecision( Camera& cam );
+	//
+	// now: capture time of the current frame, in ms. Attacks are timed against it
+	bool RobotMoveDecision( Camera& cam, const double now );
 
 	//====================================================================================================================
 	// This function returns true if the puck is behind the robot and
@@ -83,7 +84,7 @@ public:
 		return m_AttackStatus;
 	}
 
-	clock_t GetAttackTime() const
+	double GetAttackTime() const
 	{
 		return m_AttackTime;
 	}
@@ -91,7 +92,7 @@ public:
 private:
 
     BOT_STATUS		    m_RobotStatus;
-	clock_t			    m_AttackTime;
+	double			    m_AttackTime; // ms, in frame capture time. 0: no attack scheduled
 
 	ATTACK_STATUS		m_AttackStatus;
 
@@ -0,0 +1,101 @@
+#include "RoiTracker.h"
+
+const double RoiTracker::SMALL_SEARCH = 0.05;
+
+//===================================================================================
+RoiTracker::RoiTracker()
+	: m_Enabled( false )
+	, m_MinRadius( 24 )
+	, m_MaxMisses( 3 )
+	, m_HasPrediction( false )
+	, m_Uncertainty( 0.0f )
+	, m_NumMisses( 0 )
+	, m_NumTracked( 0 )
+	, m_NumHits( 0 )
+	, m_NumFull( 0 )
+	, m_NumSmall( 0 )
+	, m_SumSearched( 0.0 )
+{}
+
+//===================================================================================
+void RoiTracker::Predict( const cv::Point& pos, const float uncertainty )
+{
+	m_HasPrediction = true;
+	m_PredictPos = pos;
+	m_Uncertainty = uncertainty;
+	m_NumMisses = 0;
+} // Predict
+
+//===================================================================================
+void RoiTracker::Lose()
+{
+	m_HasPrediction = false;
+} // Lose
+
+//===================================================================================
+bool RoiTracker::GetWindow( const cv::Rect& bounds, cv::Rect& win ) const
+{
+	if ( !m_Enabled || !m_HasPrediction )
+	{
+		return false;
+	}
+
+	// the disk may have drifted further with every frame it was missed
+	const int r = static_cast<int>( ( m_MinRadius + m_Uncertainty ) * ( 1 + m_NumMisses ) );
+
+	win = cv::Rect( m_PredictPos.x - r, m_PredictPos.y - r, 2 * r + 1, 2 * r + 1 ) & bounds;
+
+	// predicted out of bounds
+	return win.area() > 0;
+} // GetWindow
+
+//===================================================================================
+void RoiTracker::Update( const bool tracked, const bool found, const double searched )
+{
+	m_SumSearched += searched;
+	if ( searched < SMALL_SEARCH )
+	{
+		m_NumSmall++;
+	}
+
+	if ( !tracked )
+	{
+		m_NumFull++;
+		return;
+	}
+
+	m_NumTracked++;
+
+	if ( found )
+	{
+		m_NumHits++;
+		m_NumMisses = 0;
+		return;
+	}
+
+	m_NumMisses++;
+	if ( m_NumMisses > m_MaxMisses )
+	{
+		Lose();
+	}
+} // Update
+
+//===================================================================================
+double RoiTracker::GetHitRate() const
+{
+	return m_NumTracked > 0 ? static_cast<double>( m_NumHits ) / m_NumTracked : 0.0;
+} // GetHitRate
+
+//===================================================================================
+double RoiTracker::GetSearchedFraction() const
+{
+	const long n = m_NumTracked + m_NumFull;
+	return n > 0 ? m_SumSearched / n : 0.0;
+} // GetSearchedFraction
+
+//===================================================================================
+double RoiTracker::GetSmallSearchRate() const
+{
+	const long n = m_NumTracked + m_NumFull;
+	return n > 0 ? static_cast<double>( m_NumSmall ) / n : 0.0;
+} // GetSmallSearchRate
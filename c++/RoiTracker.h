@@ -0,0 +1,95 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+//===================================================================================
+// Decides where to search a disk (puck, robot) in the next frame.
+// After a detection, the caller predicts the next position and how far off the
+// prediction may be; the next search is then limited to a square window around it,
+// grown by each miss. After too many misses in a row, or when the prediction is
+// lost (Lose()), the next search is over the whole frame again.
+//===================================================================================
+class RoiTracker
+{
+public:
+	RoiTracker();
+
+	// track at all. Off: every search is over the whole frame
+	void SetEnabled( const bool ok )
+	{
+		m_Enabled = ok;
+	}
+
+	// half size of the window when the prediction is exact, pixels
+	void SetMinRadius( const int r )
+	{
+		m_MinRadius = r;
+	}
+
+	// number of misses in a row in the window before searching the whole frame
+	void SetMaxMisses( const unsigned int n )
+	{
+		m_MaxMisses = n;
+	}
+
+	// where the disk should be in the next frame (image coordinate), and how far off
+	// it may be (pixels), e.g. its travel at the measured speed over one frame
+	void Predict( const cv::Point& pos, const float uncertainty );
+
+	// no usable prediction, e.g. PREDICT_STATUS::ERROR. The next search is full frame
+	void Lose();
+
+	// the window to search, clipped to bounds, e.g. the frame or the table.
+	// false: search all of bounds
+	bool GetWindow( const cv::Rect& bounds, cv::Rect& win ) const;
+
+	// the result of a search
+	// tracked: it was in the window given by GetWindow(), otherwise in the whole frame
+	// searched: fraction of the bounds that was searched
+	void Update( const bool tracked, const bool found, const double searched );
+
+	// number of searches in the window, and how many found the disk
+	long GetNumTracked() const
+	{
+		return m_NumTracked;
+	}
+
+	long GetNumHits() const
+	{
+		return m_NumHits;
+	}
+
+	// hits / tracked searches
+	double GetHitRate() const;
+
+	// number of searches over the whole frame
+	long GetNumFullSearches() const
+	{
+		return m_NumFull;
+	}
+
+	// average fraction of the frame searched, over all searches
+	double GetSearchedFraction() const;
+
+	// fraction of the searches over less than SMALL_SEARCH of the frame
+	double GetSmallSearchRate() const;
+
+	static const double SMALL_SEARCH;
+
+private:
+	bool			m_Enabled;
+	int				m_MinRadius;		// pixels
+	unsigned int	m_MaxMisses;
+
+	bool			m_HasPrediction;
+	cv::Point		m_PredictPos;		// image coordinate
+	float			m_Uncertainty;		// pixels
+	unsigned int	m_NumMisses;		// in a row, in the window
+
+	// stats
+	long			m_NumTracked;
+	long			m_NumHits;
+	long			m_NumFull;
+	long			m_NumSmall;			// searches over less than SMALL_SEARCH
+	double			m_SumSearched;
+}; // RoiTracker
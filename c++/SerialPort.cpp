@@ -5,6 +5,13 @@
 
 #include "SerialPort.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#ifdef _WIN32
 SerialPort::SerialPort(char *portName)
 {
     m_Connected = false;
@@ -113,6 +120,80 @@ bool SerialPort::WriteSerialPort( TYPE *buffer, unsigned int buf_size )
 
 } // WriteSerialPort
 
+#else
+SerialPort::SerialPort(char *portName)
+{
+    m_Connected = false;
+
+	m_Fd = open( portName, O_RDWR | O_NOCTTY | O_NONBLOCK );
+
+	if ( m_Fd < 0 )
+	{
+		printf( "ERROR: Handle was not attached. Reason: %s not available\n", portName );
+	}
+	else
+	{
+		termios tty;
+
+		if ( tcgetattr( m_Fd, &tty ) != 0 )
+		{
+			printf( "failed to get current serial parameters" );
+		}
+		else
+		{
+			// 115200 8N1, raw bytes; opening the port raises DTR, which resets the Arduino
+			cfmakeraw( &tty );
+			cfsetispeed( &tty, B115200 );
+			cfsetospeed( &tty, B115200 );
+			tty.c_cflag |= CLOCAL | CREAD;
+			tty.c_cflag &= ~( PARENB | CSTOPB | CRTSCTS );
+
+			if ( tcsetattr( m_Fd, TCSANOW, &tty ) != 0 )
+			{
+				printf( "ALERT: could not set Serial port parameters\n" );
+			}
+			else
+			{
+				m_Connected = true;
+				tcflush( m_Fd, TCIOFLUSH );
+				usleep( ARDUINO_WAIT_TIME * 1000 );
+			}
+		}
+	}
+} // SerialPort::SerialPort(char *portName)
+
+//=======================================================================
+SerialPort::~SerialPort()
+{
+	if ( m_Fd >= 0 )
+	{
+		m_Connected = false;
+		close( m_Fd );
+	}
+} // SerialPort::~SerialPort()
+
+//=======================================================================
+template <typename TYPE>
+int SerialPort::ReadSerialPort( TYPE *buffer, unsigned int buf_size )
+{
+	// what's there, without waiting
+	const ssize_t bytesRead = read( m_Fd, buffer, buf_size );
+
+	return bytesRead > 0 ? static_cast<int>( bytesRead ) : 0;
+} // ReadSerialPort
+
+//=======================================================================
+template <typename TYPE>
+bool SerialPort::WriteSerialPort( TYPE *buffer, unsigned int buf_size )
+{
+	const ssize_t bytesSend = write( m_Fd, buffer, buf_size );
+
+	return bytesSend == static_cast<ssize_t>( buf_size );
+
+} // WriteSerialPort
+
+#endif // _WIN32
+
 //=======================================================================
 bool SerialPort::IsConnected()
 {
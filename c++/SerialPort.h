@@ -7,7 +7,12 @@
 #define ARDUINO_WAIT_TIME 2000
 #define MAX_DATA_LENGTH 255
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+typedef unsigned char BYTE; // as in windows.h
+#endif // _WIN32
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -26,8 +31,12 @@ public:
     bool	IsConnected();
 
 private:
-	HANDLE		m_Handle;
 	bool		m_Connected;
+#ifdef _WIN32
+	HANDLE		m_Handle;
 	COMSTAT		m_Status;
 	DWORD		m_Errors;
+#else
+	int			m_Fd;		// the tty, non-blocking
+#endif // _WIN32
 };
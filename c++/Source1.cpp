@@ -10,6 +10,7 @@
 #include "BotManager.h"
 #include "CheckHSV.h"
 #include "ImgComposer.h"
+#include "SyntheticTableSource.h"
 
 using namespace cv;
 using namespace std;
@@ -68,7 +69,7 @@ int main()
 	// Read from config
 	//////////////////////
 	std::vector<int> tmp;
-	if ( !ReadConfig( tmp, 34 ) ) // read configuration file
+	if ( !ReadConfig( tmp, 54 ) ) // read configuration file
 	{
 		return 0;
 	}
@@ -76,7 +77,7 @@ int main()
 	const int operation		= tmp[0]; // 1. run the program, 2. check HSV, 3. record webcam images only
 	int inputType			= tmp[1];
 	int outputType			= tmp[2];
-	const bool showDebugImg	= tmp[3] == 1 ? true : false;
+	bool showDebugImg		= tmp[3] == 1 ? true : false;
 	bool showInputImg		= tmp[4] == 1 ? true : false;
 	bool showOutputImg		= tmp[5] == 1 ? true : false;
 	const bool manualPickTableCorners	= tmp[6] == 1 ? true : false;
@@ -99,6 +100,46 @@ int main()
 	const double botAreaHigh = static_cast<double>( tmp[31] );
 	const bool testMotion = tmp[32] == 1 ? true : false;
 	const bool correctMissingSteps = tmp[33] == 1 ? true : false;
+	const int decodeThreads = tmp[34];
+	const int decodeDepth = tmp[35];
+	const bool headless = tmp[36] == 1 ? true : false;
+
+	// table corners, ul, ur, ll, lr. negative: pick them on screen
+	const cv::Point cornerUL( tmp[37], tmp[38] );
+	const cv::Point cornerUR( tmp[39], tmp[40] );
+	const cv::Point cornerLL( tmp[41], tmp[42] );
+	const cv::Point cornerLR( tmp[43], tmp[44] );
+	const bool cornersGiven = cornerUL.x >= 0 && cornerUR.x >= 0 && cornerLL.x >= 0 && cornerLR.x >= 0;
+
+	const int clockMode = tmp[45];
+	const unsigned int pyramidLevel = tmp[46] > 0 ? static_cast<unsigned int>( tmp[46] ) : 0;
+	int colorKernel = tmp[47];
+	int colorLutBits = tmp[48];
+	const bool tracking = tmp[49] == 1 ? true : false;
+	const int detectThreads = tmp[50];
+	const double lineTime = tmp[51] / 1000.0; // ms
+	const double exposureTime = tmp[52] / 10.0; // ms
+	const bool yuyvInput = tmp[53] == 1 ? true : false;
+
+	if ( colorKernel < ColorSegmenter::SCALAR || colorKernel > ColorSegmenter::LUT )
+	{
+		std::cout << "color segmentation " << colorKernel << " is unknown, using scalar" << std::endl;
+		colorKernel = ColorSegmenter::SCALAR;
+	}
+
+	if ( colorLutBits < 1 || colorLutBits > 8 )
+	{
+		std::cout << "lookup table bits " << colorLutBits << " out of 1 - 8, using 8" << std::endl;
+		colorLutBits = 8;
+	}
+
+	if ( headless )
+	{
+		// nothing to show on
+		showDebugImg = false;
+		showInputImg = false;
+		showOutputImg = false;
+	}
 
 	switch ( operation )
 	{
@@ -109,7 +150,7 @@ int main()
 		break;
 	case 3: // record webcam images
 		inputType = 2; // web cam
-		outputType = 0; // images
+		outputType = outputType == 3 ? 3 : 0; // raw recording, or images
 		break;
 	case 4: // create resulting imgs by Log.txt
 		inputType = 0; // images
@@ -130,13 +171,25 @@ int main()
 	}
 
 	char comPort[20];
+#ifdef _WIN32
 	sprintf_s( comPort, "\\\\.\\COM%d", com);
+#else
+	snprintf( comPort, sizeof( comPort ), "/dev/ttyACM%d", com ); // Arduino over USB
+#endif // _WIN32
+
+	if ( operation == 1 && headless && !cornersGiven )
+	{
+		// there's no screen to pick them on
+		std::cout << "headless: table corners must be given" << std::endl;
+		return -1;
+	}
 
 	// Create video procesor instance
 	VideoProcessor processor;
 	BotManager segmentor( comPort );
 	CheckHSV hsvChecker;
 	ImgComposer imgComposer;
+	SyntheticTableSource synthetic;
 
 	if ( operation == 1 && inputType == 2 && !segmentor.IsSerialConnected() )
 	{
@@ -158,6 +211,20 @@ int main()
 	segmentor.SetBotAreaThreshHigh( botAreaHigh );
 	segmentor.m_Debug = testMotion;
 	segmentor.SetCorrectMissingSteps( correctMissingSteps );
+	segmentor.SetHeadless( headless );
+	segmentor.SetPyramidLevel( pyramidLevel );
+	segmentor.SetColorKernel( static_cast<ColorSegmenter::KERNEL>( colorKernel ) );
+	segmentor.SetColorLutBits( colorLutBits );
+	segmentor.SetTracking( tracking );
+	segmentor.SetNumThreads( detectThreads < 0 ?
+		std::thread::hardware_concurrency() : static_cast<unsigned int>( detectThreads ) );
+	segmentor.SetLineTime( lineTime );
+	segmentor.SetExposureTime( exposureTime );
+
+	if ( cornersGiven )
+	{
+		segmentor.SetTableCorners( cornerUL, cornerUR, cornerLL, cornerLR );
+	}
 
 	FrameProcessor * proc = NULL;
 	switch ( operation )
@@ -192,7 +259,7 @@ int main()
 			for (int i = 0; i < endFrame; i++)
 			{
 				char buffer[100];
-				sprintf_s(buffer, "%s%s%03i.jpg", inPath, filename,i);
+				snprintf( buffer, sizeof( buffer ), "%s%s%03i.jpg", inPath, filename,i );
 
 				std::string name = buffer;
 				imgs.push_back(name);
@@ -208,7 +275,7 @@ int main()
 			// input: video
 			/////////////////////////
 			char buffer[100];
-			sprintf_s(buffer, "%s%s.mp4", inPath, filename);
+			snprintf( buffer, sizeof( buffer ), "%s%s.mp4", inPath, filename );
 
 			std::string name = buffer;
 			if (!processor.SetInput(name))
@@ -223,7 +290,38 @@ int main()
 			/////////////////////////
 			// input: webcam
 			/////////////////////////
-			processor.SetInput( webCamId ); //webcam
+			processor.SetInput( webCamId, yuyvInput ); //webcam
+		}
+		break;
+
+		case 3:
+		{
+			/////////////////////////
+			// input: raw recording
+			/////////////////////////
+			char buffer[100];
+			snprintf( buffer, sizeof( buffer ), "%s%s.raw", inPath, filename );
+
+			if ( !processor.SetRawInput( buffer ) )
+			{
+				std::cout << "open file error" << std::endl;
+			}
+		}
+		break;
+
+		case 4:
+		{
+			/////////////////////////
+			// input: generated table scene
+			/////////////////////////
+			synthetic.Open( cv::Size( 640, 360 ), 30.0, endFrame );
+			processor.SetInput( &synthetic );
+
+			// the corners are known exactly, no need to pick or refine them
+			cv::Point ul, ur, ll, lr;
+			synthetic.GetTableCorners( ul, ur, ll, lr );
+			segmentor.SetTableCorners( ul, ur, ll, lr );
+			segmentor.SetManualPickTableCorners( true );
 		}
 		break;
 
@@ -242,7 +340,7 @@ int main()
 			// output: images
 			/////////////////////////
 			char buffer[100];
-			sprintf_s(buffer, "%s%s", outPath, filename);
+			snprintf( buffer, sizeof( buffer ), "%s%s", outPath, filename );
 
 			processor.SetOutput(buffer, ".jpg");
 		}
@@ -254,7 +352,7 @@ int main()
 			// output: video
 			/////////////////////////
 			char buffer[100];
-			sprintf_s(buffer, "%s%s.mp4", outPath, filename );
+			snprintf( buffer, sizeof( buffer ), "%s%s.mp4", outPath, filename );
 
 			int codec = CV_FOURCC( 'D', 'I', 'V', 'X' );
 			int fps = 30;
@@ -266,6 +364,21 @@ int main()
 
 		// case 2:// no output
 
+		case 3:
+		{
+			/////////////////////////
+			// output: raw recording
+			/////////////////////////
+			char buffer[100];
+			snprintf( buffer, sizeof( buffer ), "%s%s.raw", outPath, filename );
+
+			if ( !processor.SetRawOutput( buffer ) )
+			{
+				std::cout << "open file error" << std::endl;
+			}
+		}
+		break;
+
 		default:
 			break;
 	}//switch (outputType)
@@ -291,10 +404,36 @@ int main()
 	}
 
 	processor.SetDelay(delay);
+	processor.SetHeadless( headless );
+
+	// a live camera can only run in real time
+	processor.SetClockMode( inputType == 2 ? Clock::REAL_TIME : static_cast<Clock::MODE>( clockMode ) );
 	processor.SetDownSampleRate(1);
 
+	// live play: capture on its own thread so the bot always works on the newest frame
+	processor.SetThreadedCapture( operation == 1 && inputType == 2 );
+
+	// encode the recording in the background. Live: never hold up the frame loop,
+	// drop the oldest queued frames if the writer falls behind. Offline: keep every frame
+	processor.SetAsyncOutput( outputType != 2, 16,
+		inputType == 2 ? AsyncFrameWriter::DROP_OLDEST : AsyncFrameWriter::BLOCK );
+
+	// replay: decode the images ahead on a pool of threads
+	if ( inputType == 0 )
+	{
+		const unsigned int numThreads = decodeThreads < 0 ?
+			std::thread::hardware_concurrency() : static_cast<unsigned int>( decodeThreads );
+
+		processor.SetDecodeAhead( numThreads, static_cast<unsigned int>( decodeDepth ) );
+	}
+
 	// Start the Process
 	processor.Run();
 
+	if ( proc == &segmentor )
+	{
+		segmentor.PrintStats();
+	}
+
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "StopChannel.h"
+
+#include <csignal>
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <deque>
+
+static volatile std::sig_atomic_t	s_SignalStop = 0;	// set by the signal handler
+static std::atomic<bool>			s_Stop( false );	// set by stdin or RequestStop()
+static std::atomic<bool>			s_Opened( false );
+
+static std::mutex					s_Mutex;
+static std::deque<std::string>		s_Commands;	// not polled when unused: bounded
+
+#define MAX_COMMANDS	16
+
+//=======================================================================
+extern "C" void OnStopSignal( int )
+{
+	s_SignalStop = 1;
+}
+
+//=======================================================================
+// reads stdin line by line until it's closed
+static void ReadStdin()
+{
+	std::string line;
+
+	while ( std::getline( std::cin, line ) )
+	{
+		if ( line == "q" || line == "quit" )
+		{
+			s_Stop = true;
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock( s_Mutex );
+		s_Commands.push_back( line );
+
+		// nobody may be polling: drop the oldest
+		if ( s_Commands.size() > MAX_COMMANDS )
+		{
+			s_Commands.pop_front();
+		}
+	}
+} // ReadStdin
+
+//=======================================================================
+void StopChannel::Open( const bool readStdin )
+{
+	if ( s_Opened.exchange( true ) )
+	{
+		return;
+	}
+
+	std::signal( SIGINT, OnStopSignal );
+	std::signal( SIGTERM, OnStopSignal );
+
+	if ( readStdin )
+	{
+		// blocks in getline for as long as the program runs, so it's never joined
+		std::thread( ReadStdin ).detach();
+	}
+} // Open
+
+//=======================================================================
+bool StopChannel::IsStopRequested()
+{
+	return s_SignalStop != 0 || s_Stop;
+}
+
+//=======================================================================
+void StopChannel::RequestStop()
+{
+	s_Stop = true;
+}
+
+//=======================================================================
+bool StopChannel::PollCommand( std::string& cmd )
+{
+	std::lock_guard<std::mutex> lock( s_Mutex );
+
+	if ( s_Commands.empty() )
+	{
+		return false;
+	}
+
+	cmd = s_Commands.front();
+	s_Commands.pop_front();
+	return true;
+} // PollCommand
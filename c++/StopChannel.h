@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+//===================================================================================
+// Portable, non-blocking stop and control channel for running without a screen.
+// - SIGINT / SIGTERM (Ctrl+C, kill) request a stop
+// - "q" or "quit" typed on stdin request a stop; other lines are queued as commands
+//   (e.g. the keys of BotManager's motion test). Only the latest few are kept
+// Nothing here blocks the caller: stdin is read on a background thread.
+//===================================================================================
+class StopChannel
+{
+public:
+	// install the signal handlers, and start reading stdin if readStdin.
+	// Safe to call more than once
+	static void Open( const bool readStdin = true );
+
+	static bool IsStopRequested();
+
+	// request a stop from the program itself
+	static void RequestStop();
+
+	// @brief: the oldest command typed on stdin that hasn't been polled yet
+	// @return false if there's none
+	static bool PollCommand( std::string& cmd );
+}; // StopChannel
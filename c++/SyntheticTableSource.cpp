@@ -0,0 +1,190 @@
+#include "SyntheticTableSource.h"
+#include "TableFinder.h" // for TABLE_LENGTH, TABLE_WIDTH
+
+#include <opencv2/imgproc.hpp>
+
+#include <cmath>
+
+// colors, BGR. In HSV (OpenCV ranges):
+#define BACKGROUND	cv::Scalar(  40,  40,  40 ) // dark gray
+#define TABLE		cv::Scalar( 235, 235, 235 ) // white, s = 0
+#define BORDER		cv::Scalar(  20,  20,  20 ) // table rim
+#define PUCK		cv::Scalar(  60,  20, 200 ) // h = 173, s = 229, v = 200: red
+#define BOT			cv::Scalar( 120,  80,  60 ) // h = 110, s = 128, v = 120: blue
+
+namespace
+{
+	//=======================================================================
+	// position of a point moving freely on a line, folded back into [lo, hi]
+	// each time it hits an end, i.e. bouncing between the 2 ends without losing speed
+	double Fold( const double x, const double lo, const double hi )
+	{
+		const double len = hi - lo;
+		if ( len <= 0.0 )
+		{
+			return lo;
+		}
+
+		double u = std::fmod( x - lo, 2.0 * len );
+		if ( u < 0.0 )
+		{
+			u += 2.0 * len;
+		}
+
+		return lo + ( u <= len ? u : 2.0 * len - u );
+	} // Fold
+} // namespace
+
+//=======================================================================
+SyntheticTableSource::SyntheticTableSource()
+	: m_Opened( false )
+	, m_Fps( 30.0 )
+	, m_NumFrames( 0 )
+	, m_Pos( 0 )
+	, m_StartTime( 0.0 )
+	, m_PuckRadius( 12 )
+	, m_BotRadius( 16 )
+	, m_PuckVelocity( -420.0, 230.0 )
+	, m_Noise( 0.0 )
+{}
+
+//=======================================================================
+void SyntheticTableSource::Open( const cv::Size& size, const double fps, const long numFrames )
+{
+	m_Size = size;
+	m_Fps = fps > 0.0 ? fps : 30.0;
+	m_NumFrames = numFrames > 0 ? numFrames : 0;
+	m_Pos = 0;
+	m_StartTime = FrameInfo::Now();
+
+	// the largest table with the real table's proportions, with a margin around it
+	const int margin = size.height / 12;
+	int w = size.width - 2 * margin;
+	int h = static_cast<int>( w * static_cast<double>( TABLE_WIDTH ) / TABLE_LENGTH );
+	if ( h > size.height - 2 * margin )
+	{
+		h = size.height - 2 * margin;
+		w = static_cast<int>( h * static_cast<double>( TABLE_LENGTH ) / TABLE_WIDTH );
+	}
+
+	m_Table = cv::Rect( ( size.width - w ) / 2, ( size.height - h ) / 2, w, h );
+
+	// start on the right half, heading for the robot
+	m_PuckStart = cv::Point2d( m_Table.x + w * 0.75, m_Table.y + h * 0.3 );
+
+	m_Frame.create( size, CV_8UC3 );
+	m_Opened = true;
+} // Open
+
+//=======================================================================
+void SyntheticTableSource::GetTableCorners( cv::Point& ul, cv::Point& ur, cv::Point& ll, cv::Point& lr ) const
+{
+	ul = m_Table.tl();
+	ur = cv::Point( m_Table.x + m_Table.width, m_Table.y );
+	ll = cv::Point( m_Table.x, m_Table.y + m_Table.height );
+	lr = m_Table.br();
+}
+
+//=======================================================================
+cv::Point2d SyntheticTableSource::GetPuckPos( const long i ) const
+{
+	const double t = i / m_Fps; // s
+
+	const double x = Fold( m_PuckStart.x + m_PuckVelocity.x * t,
+		m_Table.x + m_PuckRadius, m_Table.x + m_Table.width - m_PuckRadius );
+
+	const double y = Fold( m_PuckStart.y + m_PuckVelocity.y * t,
+		m_Table.y + m_PuckRadius, m_Table.y + m_Table.height - m_PuckRadius );
+
+	return cv::Point2d( x, y );
+} // GetPuckPos
+
+//=======================================================================
+cv::Point2d SyntheticTableSource::GetBotPos( const long i ) const
+{
+	const double t = i / m_Fps; // s
+
+	// in front of the goal, sweeping across the middle half of the table once every 2 s
+	const double x = m_Table.x + m_Table.width * 0.08;
+	const double y = m_Table.y + m_Table.height * ( 0.5 + 0.25 * std::sin( t * CV_PI ) );
+
+	return cv::Point2d( x, y );
+} // GetBotPos
+
+//=======================================================================
+void SyntheticTableSource::Render( const long i )
+{
+	m_Frame.setTo( BACKGROUND );
+
+	cv::rectangle( m_Frame, m_Table, TABLE, cv::FILLED );
+	cv::rectangle( m_Frame, m_Table, BORDER, 2 );
+
+	// center line and goals, gray so they don't pass any color threshold
+	const int cx = m_Table.x + m_Table.width / 2;
+	cv::line( m_Frame, cv::Point( cx, m_Table.y ), cv::Point( cx, m_Table.y + m_Table.height ), cv::Scalar( 180, 180, 180 ), 1 );
+
+	const cv::Point2d puck = GetPuckPos( i );
+	const cv::Point2d bot = GetBotPos( i );
+
+	cv::circle( m_Frame, cv::Point( cvRound( bot.x ), cvRound( bot.y ) ), m_BotRadius, BOT, cv::FILLED, cv::LINE_AA );
+	cv::circle( m_Frame, cv::Point( cvRound( puck.x ), cvRound( puck.y ) ), m_PuckRadius, PUCK, cv::FILLED, cv::LINE_AA );
+
+	if ( m_Noise > 0.0 )
+	{
+		m_NoiseImg.create( m_Size, CV_16SC3 );
+		cv::randn( m_NoiseImg, cv::Scalar::all( 0.0 ), cv::Scalar::all( m_Noise ) );
+		cv::add( m_Frame, m_NoiseImg, m_Frame, cv::noArray(), CV_8UC3 );
+	}
+} // Render
+
+//=======================================================================
+bool SyntheticTableSource::Grab( cv::Mat& frame, FrameInfo& info )
+{
+	if ( !m_Opened || ( m_NumFrames > 0 && m_Pos >= m_NumFrames ) )
+	{
+		return false;
+	}
+
+	Render( m_Pos );
+
+	// stamped at the nominal frame rate
+	info.m_Index = m_Pos;
+	info.m_SourceTime = m_Pos * 1000.0 / m_Fps;
+	info.m_CaptureTime = m_StartTime + info.m_SourceTime;
+
+	frame = m_Frame;
+
+	m_Pos++;
+
+	return true;
+} // Grab
+
+//=======================================================================
+bool SyntheticTableSource::SetFrameNumber( long pos )
+{
+	if ( pos < 0 || ( m_NumFrames > 0 && pos > m_NumFrames ) )
+	{
+		return false;
+	}
+
+	m_Pos = pos;
+	return true;
+}
+
+//=======================================================================
+bool SyntheticTableSource::SetPositionMS( double pos )
+{
+	return SetFrameNumber( static_cast<long>( pos * m_Fps / 1000.0 + 0.5 ) );
+}
+
+//=======================================================================
+bool SyntheticTableSource::SetRelativePosition( double pos )
+{
+	// undefined for an endless sequence
+	if ( m_NumFrames == 0 )
+	{
+		return false;
+	}
+
+	return SetFrameNumber( static_cast<long>( pos * m_NumFrames + 0.5 ) );
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "FrameSource.h"
+
+//===================================================================================
+// A generated table scene: a white table on a dark background, a red puck bouncing
+// off the walls and a blue robot moving back and forth in front of its goal (left).
+// Colors and sizes are picked to pass the default thresholds in Config.ini.
+// The scene is a function of time only, so any frame can be generated in any order.
+// Frames are time-stamped at the nominal frame rate, regardless of how fast they're
+// generated, so the pipeline sees the same motion whether it runs slower or faster
+// than real time.
+//===================================================================================
+class SyntheticTableSource : public FrameSource
+{
+public:
+	SyntheticTableSource();
+
+	// @brief: start generating frames
+	// numFrames: number of frames in the sequence, 0 for endless
+	void Open(
+		const cv::Size& size = cv::Size( 640, 360 ),
+		const double fps = 30.0,
+		const long numFrames = 0 );
+
+	bool IsOpened() const override
+	{
+		return m_Opened;
+	}
+
+	void Close() override
+	{
+		m_Opened = false;
+	}
+
+	// puck velocity, in table pixels per second
+	void SetPuckVelocity( const cv::Point2d& v )
+	{
+		m_PuckVelocity = v;
+	}
+
+	// standard deviation of Gaussian noise added to each frame, 0: none
+	void SetNoise( const double sigma )
+	{
+		m_Noise = sigma;
+	}
+
+	// table corners in the generated image, e.g. for BotManager::SetTableCorners()
+	// arranged by ul, ur, ll, lr
+	void GetTableCorners( cv::Point& ul, cv::Point& ur, cv::Point& ll, cv::Point& lr ) const;
+
+	// puck center in frame i, image coordinate
+	cv::Point2d GetPuckPos( const long i ) const;
+
+	// robot center in frame i, image coordinate
+	cv::Point2d GetBotPos( const long i ) const;
+
+	bool Grab( cv::Mat& frame, FrameInfo& info ) override;
+
+	cv::Size GetFrameSize() override
+	{
+		return m_Size;
+	}
+
+	// every frame is drawn into the same buffer
+	bool IsZeroCopy() const override
+	{
+		return true;
+	}
+
+	long GetFrameNumber() override
+	{
+		return m_Pos;
+	}
+
+	long GetTotalFrameCount() override
+	{
+		return m_NumFrames;
+	}
+
+	double GetPositionMS() override
+	{
+		return m_Pos * 1000.0 / m_Fps;
+	}
+
+	double GetFrameRate() override
+	{
+		return m_Fps;
+	}
+
+	bool SetFrameNumber( long pos ) override;
+
+	bool SetPositionMS( double pos ) override;
+
+	bool SetRelativePosition( double pos ) override;
+
+private:
+	// draw frame i into m_Frame
+	void Render( const long i );
+
+	bool		m_Opened;
+	cv::Size	m_Size;
+	double		m_Fps;
+	long		m_NumFrames;	// 0: endless
+	long		m_Pos;			// index of the next frame
+	double		m_StartTime;	// capture time of frame 0 (ms)
+
+	cv::Rect	m_Table;		// table area in the image
+	int			m_PuckRadius;	// pixel
+	int			m_BotRadius;	// pixel
+
+	cv::Point2d	m_PuckStart;	// puck position at frame 0, image coordinate
+	cv::Point2d	m_PuckVelocity;	// pixel / s
+	double		m_Noise;
+
+	cv::Mat		m_Frame;		// generated frame
+	cv::Mat		m_NoiseImg;		// workspace for the noise
+}; // SyntheticTableSource
@@ -15,26 +15,48 @@ TableFinder::TableFinder(
 	:LineFinder(m, dRho, dTheta, minVote, minLength, maxGap)
 {}
 
+//===================================================================================
+// p mapped by the homography H
+static cv::Point2f Project( const cv::Matx33d& H, const double x, const double y )
+{
+	const double w = H( 2, 0 ) * x + H( 2, 1 ) * y + H( 2, 2 );
+
+	return cv::Point2f(
+		static_cast<float>( ( H( 0, 0 ) * x + H( 0, 1 ) * y + H( 0, 2 ) ) / w ),
+		static_cast<float>( ( H( 1, 0 ) * x + H( 1, 1 ) * y + H( 1, 2 ) ) / w ) );
+} // Project
+
 //===================================================================================
 cv::Point TableFinder::ImgToTableCoordinate( cv::Point p )
 {
-	cv::Point ret;
-	ret.y = static_cast<int>( ( p.x - m_Left ) * m_PixToMM );
-	ret.x = static_cast<int>( ( p.y - m_Top ) * m_PixToMM );
+	if ( p.x >= 0 && p.y >= 0 && p.x < m_ImgToTableLut.cols && p.y < m_ImgToTableLut.rows )
+	{
+		const cv::Vec2f& t = m_ImgToTableLut.at<cv::Vec2f>( p.y, p.x );
+		return cv::Point( cvRound( t[0] ), cvRound( t[1] ) );
+	}
 
-	return ret;
+	return cv::Point( Project( m_ImgToTable, p.x, p.y ) );
+} // ImgToTableCoordinate
+
+//===================================================================================
+cv::Point2f TableFinder::ImgToTableCoordinate( const cv::Point2f& p ) const
+{
+	return Project( m_ImgToTable, p.x, p.y );
 } // ImgToTableCoordinate
 
 //===================================================================================
 cv::Point TableFinder::TableToImgCoordinate( cv::Point p )
 {
-	cv::Point ret;
-	float mmToPix = 1.0f / m_PixToMM;
-	ret.y = static_cast<int>( m_Top + p.x * mmToPix );
-	ret.x = static_cast<int>( m_Left + p.y * mmToPix );
+	if ( p.x >= 0 && p.y >= 0 && p.y < m_TableToImgLut.cols && p.x < m_TableToImgLut.rows )
+	{
+		const cv::Vec2f& pix = m_TableToImgLut.at<cv::Vec2f>( p.x, p.y );
+		return cv::Point( cvRound( pix[0] ), cvRound( pix[1] ) );
+	}
 
-	return ret;
+	return cv::Point( Project( m_TableToImg, p.x, p.y ) );
 } // ImgToTableCoordinate
+
+//===================================================================================
 void TableFinder::AvgCorners()
 {
 	m_Left = ( m_TopLeft.x + m_LowerLeft.x ) * 0.5f;
@@ -42,9 +64,49 @@ void TableFinder::AvgCorners()
 	m_Top = ( m_TopLeft.y + m_TopRight.y ) * 0.5f;
 	m_Bottom = ( m_LowerLeft.y + m_LowerRight.y ) * 0.5f;
 
-	m_PixToMM = TABLE_LENGTH / ( m_Right - m_Left );
+	// the corners in table coordinate: x down the screen, y across it
+	const cv::Point2f img[4] = {
+		cv::Point2f( m_TopLeft ), cv::Point2f( m_TopRight ),
+		cv::Point2f( m_LowerLeft ), cv::Point2f( m_LowerRight ) };
+
+	const cv::Point2f table[4] = {
+		cv::Point2f( 0.0f, 0.0f ), cv::Point2f( 0.0f, TABLE_LENGTH ),
+		cv::Point2f( TABLE_WIDTH, 0.0f ), cv::Point2f( TABLE_WIDTH, TABLE_LENGTH ) };
+
+	m_ImgToTable = cv::getPerspectiveTransform( img, table );
+	m_TableToImg = m_ImgToTable.inv();
+
+	// built again for the new corners
+	m_ImgToTableLut.release();
+	m_TableToImgLut.release();
 } // AvgCorners
 
+//===================================================================================
+void TableFinder::BuildLut( const cv::Size& size )
+{
+	m_ImgToTableLut.create( size, CV_32FC2 );
+	for ( int y = 0; y < size.height; y++ )
+	{
+		cv::Vec2f* row = m_ImgToTableLut.ptr<cv::Vec2f>( y );
+		for ( int x = 0; x < size.width; x++ )
+		{
+			const cv::Point2f t = Project( m_ImgToTable, x, y );
+			row[x] = cv::Vec2f( t.x, t.y );
+		}
+	}
+
+	m_TableToImgLut.create( TABLE_WIDTH + 1, TABLE_LENGTH + 1, CV_32FC2 );
+	for ( int x = 0; x <= TABLE_WIDTH; x++ )
+	{
+		cv::Vec2f* row = m_TableToImgLut.ptr<cv::Vec2f>( x );
+		for ( int y = 0; y <= TABLE_LENGTH; y++ )
+		{
+			const cv::Point2f pix = Project( m_TableToImg, x, y );
+			row[y] = cv::Vec2f( pix.x, pix.y );
+		}
+	}
+} // BuildLut
+
 //===================================================================================
 bool TableFinder::Refine4Edges(
 	const std::vector<cv::Point> & corners,
@@ -27,8 +27,15 @@ public:
 		unsigned int bandWidth,
         cv::Mat& img /*debug use*/);
 
+	// the rectangle the corners average to (GetLeft() ...), and the homography between
+	// the image and the table from the 4 corners
 	void AvgCorners();
 
+	// precompute the table coordinate of every pixel of an image of size, and the image
+	// coordinate of every mm of the table: a mapping is then one memory load. Outside
+	// of them, the homography is computed
+	void BuildLut( const cv::Size& size );
+
 	void DrawTableLines(cv::Mat &image, cv::Scalar color = cv::Scalar(255, 255, 255));
 
 	const cv::Point& GetTopLeft()
@@ -92,8 +99,13 @@ public:
 	//  |------------------------
 	//  |
 	//  V Y
+	// The camera may look at the table at an angle: the mapping is the homography of
+	// the 4 corners, not a scale
 	cv::Point ImgToTableCoordinate( cv::Point p);
 
+	// sub-pixel to sub-mm, nothing truncated
+	cv::Point2f ImgToTableCoordinate( const cv::Point2f& p ) const;
+
 	cv::Point TableToImgCoordinate( cv::Point p );
 
 	float GetLeft()
@@ -159,16 +171,19 @@ private:
 	cv::Point m_LowerLeft;
 	cv::Point m_LowerRight;
 
-	// This is an oversimplified model that assumes
-	// image plane is parellel to table with no tilt
-	// and ignore any lense distortion.
-	// So the resulting table boundary is a rectangle on screen
+	// the corners averaged into a rectangle on screen, to draw and log it
 	float m_Left;
 	float m_Right;
 	float m_Top;
 	float m_Bottom;
 
-	// camera pixel to table mm
-	float m_PixToMM;
+	// the image plane may be tilted, the table is a plane: a homography maps one to
+	// the other (lens distortion is ignored)
+	cv::Matx33d m_ImgToTable;
+	cv::Matx33d m_TableToImg;
+
+	// precomputed mappings, CV_32FC2
+	cv::Mat m_ImgToTableLut;	// table x, y (mm) at each pixel (row = image y)
+	cv::Mat m_TableToImgLut;	// image x, y at each mm (row = table x)
 
 }; // TableFinder
@@ -0,0 +1,121 @@
+#include "TaskPool.h"
+
+//=======================================================================
+TaskPool::TaskPool()
+	: m_Task( NULL )
+	, m_Count( 0 )
+	, m_Next( 0 )
+	, m_Done( 0 )
+	, m_Stop( false )
+{}
+
+//=======================================================================
+TaskPool::~TaskPool()
+{
+	Stop();
+}
+
+//=======================================================================
+void TaskPool::Start( const unsigned int numThreads )
+{
+	Stop();
+
+	m_Stop = false;
+
+	for ( unsigned int i = 1; i < numThreads; i++ )
+	{
+		m_Workers.push_back( std::thread( &TaskPool::WorkLoop, this ) );
+	}
+} // Start
+
+//=======================================================================
+void TaskPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+		m_Stop = true;
+	}
+
+	m_TaskReady.notify_all();
+
+	for ( size_t i = 0; i < m_Workers.size(); i++ )
+	{
+		m_Workers[i].join();
+	}
+
+	m_Workers.clear();
+} // Stop
+
+//=======================================================================
+void TaskPool::Run( const Task& task, const int count )
+{
+	if ( m_Workers.empty() )
+	{
+		for ( int i = 0; i < count; i++ )
+		{
+			task( i );
+		}
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	m_Task = &task;
+	m_Count = count;
+	m_Next = 0;
+	m_Done = 0;
+
+	m_TaskReady.notify_all();
+
+	// take tasks like a worker until none is left to claim
+	while ( m_Next < m_Count )
+	{
+		const int i = m_Next++;
+
+		lock.unlock();
+		task( i );
+		lock.lock();
+
+		m_Done++;
+	}
+
+	// the workers may still be on theirs
+	m_AllDone.wait( lock, [this]()
+	{
+		return m_Done == m_Count;
+	} );
+
+	m_Task = NULL;
+} // Run
+
+//=======================================================================
+void TaskPool::WorkLoop()
+{
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	while ( true )
+	{
+		m_TaskReady.wait( lock, [this]()
+		{
+			return m_Stop || ( m_Task != NULL && m_Next < m_Count );
+		} );
+
+		if ( m_Stop )
+		{
+			break;
+		}
+
+		const int i = m_Next++;
+		const Task& task = *m_Task;
+
+		// run without holding the lock, this is where the threads run in parallel
+		lock.unlock();
+		task( i );
+		lock.lock();
+
+		if ( ++m_Done == m_Count )
+		{
+			m_AllDone.notify_one();
+		}
+	}
+} // WorkLoop
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//===================================================================================
+// A fixed set of worker threads, started once and kept for every frame, that run
+// the tasks of a Run() call in parallel. The thread calling Run() works too, so
+// with n threads there are n - 1 workers, and with 1 the tasks just run inline.
+// Run() returns when all its tasks are done; it must not be called from a task.
+//===================================================================================
+class TaskPool
+{
+public:
+	// the task of index i, called on any thread: a reference to any callable
+	// task( const int i ), e.g. a lambda. Nothing is copied or allocated, unlike a
+	// std::function; the callable only has to outlive the Run() it's given to
+	class Task
+	{
+	public:
+		template<typename F>
+		Task( const F& f )
+			: m_Callable( &f )
+			, m_Call( &Call<F> )
+		{}
+
+		void operator()( const int i ) const
+		{
+			m_Call( m_Callable, i );
+		}
+
+	private:
+		template<typename F>
+		static void Call( const void* f, const int i )
+		{
+			( *static_cast<const F*>( f ) )( i );
+		}
+
+		const void*	m_Callable;
+		void		( *m_Call )( const void* f, const int i );
+	}; // Task
+
+	TaskPool();
+
+	~TaskPool();
+
+	// (re)start with numThreads threads, the caller of Run() included. 0 counts as 1
+	void Start( const unsigned int numThreads );
+
+	// stop and join the workers
+	void Stop();
+
+	unsigned int GetNumThreads() const
+	{
+		return static_cast<unsigned int>( m_Workers.size() ) + 1;
+	}
+
+	// run task( 0 ) .. task( count - 1 ), and wait for all of them
+	void Run( const Task& task, const int count );
+
+private:
+	// worker thread body
+	void WorkLoop();
+
+	const Task*		m_Task;		// the tasks of the current Run(), NULL between runs
+	int				m_Count;
+	int				m_Next;		// next task to claim
+	int				m_Done;		// tasks finished
+	bool			m_Stop;
+
+	std::vector<std::thread>	m_Workers;
+
+	std::mutex					m_Mutex;
+	std::condition_variable		m_TaskReady;	// workers wait for tasks to claim
+	std::condition_variable		m_AllDone;		// Run() waits for the last task
+}; // TaskPool
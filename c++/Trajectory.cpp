@@ -0,0 +1,202 @@
+#include "Trajectory.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+//===================================================================================
+Trajectory::Trajectory()
+	: m_Left( 0.0f )
+	, m_Right( FLT_MAX )
+	, m_Restitution( 1.0f )
+	, m_Drag( 0.0f )
+{}
+
+//===================================================================================
+void Trajectory::SetWalls( const float left, const float right )
+{
+	m_Left = left;
+	m_Right = right;
+} // SetWalls
+
+//===================================================================================
+void Trajectory::SetRestitution( const float e )
+{
+	m_Restitution = e;
+} // SetRestitution
+
+//===================================================================================
+void Trajectory::SetFriction( const float drag )
+{
+	m_Drag = drag;
+} // SetFriction
+
+//===================================================================================
+void Trajectory::Solve( const cv::Point2f& pos, const cv::Point2f& speed )
+{
+	m_Pos = pos;
+	m_Speed = speed;
+} // Solve
+
+//===================================================================================
+float Trajectory::FirstLeg() const
+{
+	if ( m_Speed.x == 0.0f )
+	{
+		return FLT_MAX;
+	}
+
+	const float toWall = m_Speed.x > 0.0f ? m_Right - m_Pos.x : m_Pos.x - m_Left;
+	return std::max( 0.0f, toWall ) * std::abs( m_Speed.y / m_Speed.x );
+} // FirstLeg
+
+//===================================================================================
+float Trajectory::Leg() const
+{
+	if ( m_Speed.x == 0.0f )
+	{
+		return FLT_MAX;
+	}
+
+	return ( m_Right - m_Left ) * std::abs( m_Speed.y / m_Speed.x );
+} // Leg
+
+//===================================================================================
+float Trajectory::SpeedAt( const int k ) const
+{
+	const float w0 = std::abs( m_Speed.y );
+	if ( k == 0 )
+	{
+		return w0;
+	}
+
+	const float e = m_Restitution;
+	const float a1 = e * ( w0 - FirstLeg() * m_Drag );
+	const float c = Leg() * m_Drag; // lost over a leg
+
+	// a( k + 1 ) = e * ( a( k ) - c )
+	if ( e >= 1.0f )
+	{
+		return a1 - ( k - 1 ) * c;
+	}
+
+	const float fixed = -e * c / ( 1.0f - e );
+	return fixed + std::pow( e, static_cast<float>( k - 1 ) ) * ( a1 - fixed );
+} // SpeedAt
+
+//===================================================================================
+float Trajectory::TimeAt( const int k, const float h ) const
+{
+	const float w0 = std::abs( m_Speed.y );
+	const float e = m_Restitution;
+	const float end = SpeedAt( k ) - h * m_Drag;
+
+	if ( SpeedAt( k ) <= 0.0f || end <= 0.0f )
+	{
+		return -1.0f;
+	}
+
+	if ( m_Drag > 0.0f )
+	{
+		// the time of every leg is tau * ln( start / end ) and a bounce multiplies by e,
+		// so the sum telescopes
+		return std::log( std::pow( e, static_cast<float>( k ) ) * w0 / end ) / m_Drag;
+	}
+
+	if ( k == 0 )
+	{
+		return h / w0;
+	}
+
+	// the legs at w0 * e^j: a geometric sum
+	float legs = static_cast<float>( k - 1 );
+	if ( e < 1.0f )
+	{
+		const float q = 1.0f / e;
+		legs = q * ( std::pow( q, static_cast<float>( k - 1 ) ) - 1.0f ) / ( q - 1.0f );
+	}
+
+	return ( FirstLeg() + Leg() * legs + h * std::pow( e, -static_cast<float>( k ) ) ) / w0;
+} // TimeAt
+
+//===================================================================================
+float Trajectory::Fold( const float x ) const
+{
+	const float width = m_Right - m_Left;
+
+	float p = std::fmod( x - m_Left, 2.0f * width );
+	if ( p < 0.0f )
+	{
+		p += 2.0f * width;
+	}
+
+	return p <= width ? m_Left + p : m_Left + 2.0f * width - p;
+} // Fold
+
+//===================================================================================
+bool Trajectory::CrossY( const float y, Crossing& crossing ) const
+{
+	if ( m_Speed.y == 0.0f )
+	{
+		return false;
+	}
+
+	// distance along y, forward
+	const float d = ( y - m_Pos.y ) * ( m_Speed.y > 0.0f ? 1.0f : -1.0f );
+	if ( d < 0.0f )
+	{
+		return false;
+	}
+
+	const float first = FirstLeg();
+	const int n = d <= first ?
+		0 : 1 + static_cast<int>( std::floor( ( d - first ) / Leg() ) );
+
+	const float h = n == 0 ? d : d - first - ( n - 1 ) * Leg();
+	const float t = TimeAt( n, h );
+
+	if ( t < 0.0f )
+	{
+		return false;
+	}
+
+	// every bounce mirrors vx
+	const float scale = ( SpeedAt( n ) - h * m_Drag ) / std::abs( m_Speed.y );
+	const float sx = n % 2 == 0 ? 1.0f : -1.0f;
+
+	crossing.m_Pos = cv::Point2f( Fold( m_Pos.x + m_Speed.x / std::abs( m_Speed.y ) * d ), y );
+	crossing.m_Time = t;
+	crossing.m_NumBounces = n;
+	crossing.m_Speed = cv::Point2f( sx * m_Speed.x * scale, m_Speed.y * scale );
+
+	return true;
+} // CrossY
+
+//===================================================================================
+int Trajectory::GetBounces(
+	const float y,
+	cv::Point2f* points,
+	float* times,
+	const int maxBounces ) const
+{
+	Crossing crossing;
+	if ( !CrossY( y, crossing ) )
+	{
+		return -1;
+	}
+
+	const float dirY = m_Speed.y > 0.0f ? 1.0f : -1.0f;
+	const float first = FirstLeg();
+
+	for ( int k = 1; k <= crossing.m_NumBounces && k <= maxBounces; k++ )
+	{
+		// the first wall is the one it's moving to, then they alternate
+		const bool right = ( m_Speed.x > 0.0f ) == ( k % 2 == 1 );
+		const float d = first + ( k - 1 ) * Leg();
+
+		points[k - 1] = cv::Point2f( right ? m_Right : m_Left, m_Pos.y + dirY * d );
+		times[k - 1] = TimeAt( k - 1, k == 1 ? first : Leg() );
+	}
+
+	return crossing.m_NumBounces;
+} // GetBounces
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+//===================================================================================
+// The puck's path across the table, any number of side wall bounces, in table
+// coordinate (mm, ms).
+// The walls are unfolded: a bounce mirrors vx, so the path is a straight line across
+// mirrored copies of the table, and x at any y folds back with a modulo of twice the
+// width. A bounce keeps a fraction of the speed (restitution), the same for x and y
+// so the direction stays mirrored. Friction is a linear drag: the speed drops by
+// the distance travelled / tau, so vy(y) is linear between bounces and the time to a
+// y line telescopes to one log. Every query is constant time, whatever the bounces.
+//===================================================================================
+class Trajectory
+{
+public:
+
+	// where and when the path crosses a y line
+	struct Crossing
+	{
+		cv::Point2f	m_Pos;			// mm
+		float		m_Time;			// ms from the start
+		int			m_NumBounces;	// before the line
+		cv::Point2f	m_Speed;		// mm/ms, there
+	}; // Crossing
+
+	Trajectory();
+
+	// x range of the puck's center between the side walls
+	void SetWalls( const float left, const float right );
+
+	// fraction of the speed kept at a bounce, 1: elastic
+	void SetRestitution( const float e );
+
+	// speed lost per mm travelled (1/ms), 0: none
+	void SetFriction( const float drag );
+
+	// start at pos (mm), with speed (mm/ms)
+	void Solve( const cv::Point2f& pos, const cv::Point2f& speed );
+
+	// false: the line is behind, or the puck stops before it
+	bool CrossY( const float y, Crossing& crossing ) const;
+
+	// the bounces before line y, at most maxBounces of them: where and when (ms from the start)
+	// @return the number of bounces before line y, even past maxBounces. -1: never reached
+	int GetBounces(
+		const float y,
+		cv::Point2f* points,
+		float* times,
+		const int maxBounces ) const;
+
+private:
+
+	// along y from the start: to the first bounce, and between bounces
+	// (infinite when vx = 0)
+	float FirstLeg() const;
+	float Leg() const;
+
+	// y speed (> 0) at the start of leg k, right after bounce k
+	float SpeedAt( const int k ) const;
+
+	// time from the start to distance h along y past bounce k ( h from the start for k = 0 ).
+	// < 0: it stops first
+	float TimeAt( const int k, const float h ) const;
+
+	// x of the unfolded x
+	float Fold( const float x ) const;
+
+	float		m_Left;
+	float		m_Right;
+	float		m_Restitution;
+	float		m_Drag;			// 1 / tau
+
+	cv::Point2f	m_Pos;
+	cv::Point2f	m_Speed;
+}; // Trajectory
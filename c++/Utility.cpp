@@ -380,4 +380,41 @@ bool Utility::IsInsideInner(
 
     return true;
 
-} // IsInsideInner
\ No newline at end of file
+} // IsInsideInner
+
+//=======================================================================
+cv::Mat Utility::GrowOnlyView(
+    cv::Mat& buf,
+    const cv::Size& size,
+    const int type )
+{
+    if ( buf.type() != type || buf.cols < size.width || buf.rows < size.height )
+    {
+        buf.create( std::max( buf.rows, size.height ), std::max( buf.cols, size.width ), type );
+    }
+
+    return buf( cv::Rect( 0, 0, size.width, size.height ) );
+} // GrowOnlyView
+
+//=======================================================================
+void Utility::ResizeArea(
+    const cv::Mat& src,
+    cv::Mat& dst,
+    const double scale )
+{
+    if ( src.type() != CV_8UC2 )
+    {
+        cv::resize( src, dst, cv::Size(), scale, scale, cv::INTER_AREA );
+        return;
+    }
+
+    // whole pairs
+    const int cols = static_cast<int>( src.cols * scale ) & ~1;
+    const int rows = static_cast<int>( src.rows * scale );
+
+    dst.create( rows, cols, CV_8UC2 );
+
+    // a pair per pixel, written into dst
+    cv::Mat dstPairs = dst.reshape( 4 );
+    cv::resize( src.reshape( 4 ), dstPairs, dstPairs.size(), 0, 0, cv::INTER_AREA );
+} // ResizeArea
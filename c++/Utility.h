@@ -47,7 +47,7 @@ public:
 		unsigned int Yoffset);
 
 	//=======================================================================
-	static void Utility::GenerateOuterBand(
+	static void GenerateOuterBand(
 		float& o_l, // slope
 		float& o_r,
 		float& o_t,
@@ -61,7 +61,7 @@ public:
 		unsigned int Yoffset);
 
 	//=======================================================================
-	static void Utility::GenerateInnerBand(
+	static void GenerateInnerBand(
 		float& i_l, // slope
 		float& i_r,
 		float& i_t,
@@ -101,4 +101,24 @@ public:
         const cv::Point& i_ur,
         const cv::Point& i_ll,
         const cv::Point& i_lr );
+
+    //=======================================================================
+    // a view of the top-left size of buf, buf grows when it's too small.
+    // Writing into the view with the same size and type doesn't reallocate,
+    // so windows of changing size can reuse one buffer
+    //=======================================================================
+    static cv::Mat GrowOnlyView(
+        cv::Mat& buf,
+        const cv::Size& size,
+        const int type );
+
+    //=======================================================================
+    // cv::resize( INTER_AREA ) by scale, for BGR or YUYV (CV_8UC2).
+    // YUYV is resized by pairs ( Y0 U Y1 V ), so the chroma stays with its
+    // pair; the even and odd Ys are averaged separately
+    //=======================================================================
+    static void ResizeArea(
+        const cv::Mat& src,
+        cv::Mat& dst,
+        const double scale );
 }; // Utility
\ No newline at end of file
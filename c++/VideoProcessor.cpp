@@ -1,10 +1,16 @@
 #include "VideoProcessor.h"
+#include "AllocCounter.h"
+#include "StopChannel.h"
 
+#ifdef _WIN32
 #include <conio.h> // for getch
 #include <windows.h> // for kbhit
+#endif // _WIN32
 
-#define FRAME_WIDTH 640
-#define FRAME_HEIGHT 360
+// frames before the loop is expected to stop allocating (debug check only)
+#define WARM_UP_FRAMES 30
+// number of allocating frames reported one by one (debug check only)
+#define MAX_ALLOC_REPORTS 5
 
 //=======================================================================
 VideoProcessor::VideoProcessor()
@@ -21,39 +27,61 @@ VideoProcessor::VideoProcessor()
 , m_InitPosY( -1 )
 , m_OffsetX( -1 )
 , m_OffsetY( -1 )
+, m_ThreadedCapture( false )
+, m_NumCaptureSlots( 3 )
+, m_CaptureTimeout( 500 )
+, m_StopCapture( false )
+, m_Source( NULL )
+, m_Headless( false )
+, m_AsyncOutput( false )
+, m_OutputQueueDepth( 8 )
+, m_OutputPolicy( AsyncFrameWriter::BLOCK )
 {}
 
 //=======================================================================
-bool VideoProcessor::ReadNextFrame( cv::Mat& frame )
+VideoProcessor::~VideoProcessor()
 {
-    bool ok = false;
+    StopCapture();
 
-    if( m_Images.size() == 0 )
+    // write out what is still queued before the writer goes away
+    m_AsyncWriter.Stop();
+}
+
+//=======================================================================
+bool VideoProcessor::ReadNextFrame( cv::Mat& frame, FrameInfo& info )
+{
+    if( m_Source == NULL || !m_Source->Grab( m_TmpFrame, info ) )
     {
-        //////////////////////////
-        // it's video or webcam
-        //////////////////////////
-        ok = m_Capture.read( m_TmpFrame );
+        return false;
     }
-    else
-    {
-        ////////////////
-        // it's images
-        ////////////////
-        if( m_ItImg != m_Images.end() )
-        {
-            //printf( "%s\n", ( *m_ItImg ).c_str() ); // debug: print file path
-            m_TmpFrame = cv::imread( *m_ItImg );
-            m_ItImg++;
 
-            ok = m_TmpFrame.data != 0;
-        }
+    // replace the capture time by the clock's, and wait for it if paced
+    info.m_CaptureTime = m_Clock.Stamp( info, m_Source->HasSourceTime() );
+
+    const bool yuyv = m_Source->GetPixelFormat() == FrameSource::YUYV;
+
+    if( yuyv && !PassesYuyv() )
+    {
+        // the processor works on BGR
+        cv::cvtColor( m_TmpFrame, m_BgrFrame, cv::COLOR_YUV2BGR_YUYV );
+        m_TmpFrame = m_BgrFrame;
     }
 
     // whether we extract only portion of the image
+    // (copied into the workspace, which is only reallocated if the size changes)
     if( m_OffsetX > 0 && m_OffsetY > 0 && m_InitPosX >= 0 && m_InitPosY >= 0 )
     {
-        frame = m_TmpFrame( cv::Rect( m_InitPosX, m_InitPosY, m_OffsetX, m_OffsetY ) ).clone();
+        cv::Rect crop( m_InitPosX, m_InitPosY, m_OffsetX, m_OffsetY );
+
+        if( m_TmpFrame.type() == CV_8UC2 )
+        {
+            // whole YUYV pairs only
+            crop.x &= ~1;
+            crop.width &= ~1;
+        }
+
+        m_TmpFrame( crop ).copyTo( m_CropFrame );
+        frame = m_CropFrame;
     }
     else
     {
@@ -62,14 +90,98 @@ bool VideoProcessor::ReadNextFrame( cv::Mat& frame )
 
 	if (m_DownSampleRate > 1)
 	{
-		cv::resize(frame, frame, cv::Size(), 1.0 / m_DownSampleRate, 1.0 / m_DownSampleRate);
+		// resizing in place would allocate a new image every frame
+		cv::resize(frame, m_ResizeFrame, cv::Size(), 1.0 / m_DownSampleRate, 1.0 / m_DownSampleRate);
+		frame = m_ResizeFrame;
 	}
 
-    return ok;
+    return true;
+}
+
+//=======================================================================
+bool VideoProcessor::PassesYuyv() const
+{
+    // down-sampling would mix the chroma of neighbouring pairs
+    return m_CallIt && m_Process == 0 && m_FrameProcessor != 0 &&
+        m_FrameProcessor->AcceptsYuyv() && m_DownSampleRate <= 1;
 }
 
 //=======================================================================
-void VideoProcessor::WriteNextFrame( cv::Mat& frame )
+const cv::Mat& VideoProcessor::ToBgr( const cv::Mat& frame, cv::Mat& bgr )
+{
+    if( frame.type() != CV_8UC2 )
+    {
+        return frame;
+    }
+
+    cv::cvtColor( frame, bgr, cv::COLOR_YUV2BGR_YUYV );
+    return bgr;
+} // ToBgr
+
+//=======================================================================
+void VideoProcessor::CaptureLoop()
+{
+    while( !m_StopCapture )
+    {
+        if( !ReadNextFrame( m_CaptureFrame, m_CaptureInfo ) )
+        {
+            break;
+        }
+
+        m_CaptureFrame.copyTo( m_FrameRing.BeginWrite() );
+        m_FrameRing.EndWrite( m_CaptureInfo );
+    }
+
+    // let the processing loop know there are no more frames
+    m_FrameRing.Close();
+} // CaptureLoop
+
+//=======================================================================
+void VideoProcessor::StartCapture()
+{
+    StopCapture();
+
+    const bool yuyv = m_Source->GetPixelFormat() == FrameSource::YUYV && PassesYuyv();
+
+    m_FrameRing.Init( m_NumCaptureSlots, GetFrameSize(), yuyv ? CV_8UC2 : CV_8UC3 );
+
+    m_StopCapture = false;
+    m_CaptureThread = std::thread( &VideoProcessor::CaptureLoop, this );
+} // StartCapture
+
+//=======================================================================
+void VideoProcessor::StopCapture()
+{
+    if( m_CaptureThread.joinable() )
+    {
+        m_StopCapture = true;
+        m_CaptureThread.join();
+    }
+} // StopCapture
+
+//=======================================================================
+void VideoProcessor::WriteNextFrame( cv::Mat& frame, const FrameInfo& info )
+{
+    if( m_RawWriter.IsOpened() )
+    {
+        // no encoding, a plain write is cheaper than queueing a copy.
+        // A YUYV recording takes YUYV frames as they are
+        const bool asIs = m_RawWriter.GetFormat() == RawFrameFile::YUYV;
+        m_RawWriter.Write( asIs ? frame : ToBgr( frame, m_BgrOutput ), info );
+    }
+    else if( m_AsyncWriter.IsRunning() )
+    {
+        // copied, the frame loop is free to reuse its buffer
+        m_AsyncWriter.Push( ToBgr( frame, m_BgrOutput ), info );
+    }
+    else
+    {
+        EncodeFrame( ToBgr( frame, m_BgrOutput ) );
+    }
+}
+
+//=======================================================================
+void VideoProcessor::EncodeFrame( const cv::Mat& frame )
 {
     if( m_Extension.length() )
     {
@@ -96,43 +208,78 @@ bool VideoProcessor::SetInput( std::string filename )
     m_TotalFrame = 0;
     // In case a resource was already
     // associated with the VideoCapture instance
-    m_Capture.release();
-    m_Images.clear();
+    CloseInput();
 
     // Open the video file
-    return m_Capture.open( filename );
+    m_Source = &m_CaptureSource;
+    return m_CaptureSource.Open( filename );
 }
 
 //=======================================================================
-bool VideoProcessor::SetInput( int id )
+bool VideoProcessor::SetInput( int id, bool yuyv )
 {
     m_TotalFrame = 0;
     // In case a resource was already
     // associated with the VideoCapture instance
-    m_Capture.release();
-    m_Images.clear();
-
-    // Open the video file
-    bool ok = m_Capture.open( id );
+    CloseInput();
 
-    // note the setting of resolution has to come AFTER we open it!
-    ok = ok && m_Capture.set( CV_CAP_PROP_FRAME_WIDTH, FRAME_WIDTH );
-    ok = ok && m_Capture.set( CV_CAP_PROP_FRAME_HEIGHT, FRAME_HEIGHT );
-
-    return ok;
+    // Open the camera
+    m_Source = &m_CaptureSource;
+    return m_CaptureSource.Open( id, yuyv );
 }
 
 //=======================================================================
 void VideoProcessor::SetInput( const std::vector<std::string>& imgs )
 {
     m_TotalFrame = 0;
-    // In case a resource was already
-    // associated with the VideoCapture instance
-    m_Capture.release();
+    CloseInput();
 
     // the input will be this vector of m_Images
-    m_Images = imgs;
-    m_ItImg = m_Images.begin();
+    m_Source = &m_ImageListSource;
+    m_ImageListSource.Open( imgs );
+}
+
+//=======================================================================
+bool VideoProcessor::SetRawInput( const std::string& filename )
+{
+    m_TotalFrame = 0;
+    CloseInput();
+
+    m_Source = &m_RawSource;
+    return m_RawSource.Open( filename );
+}
+
+//=======================================================================
+void VideoProcessor::SetInput( FrameSource* source )
+{
+    m_TotalFrame = 0;
+    CloseInput();
+
+    m_Source = source;
+}
+
+//=======================================================================
+void VideoProcessor::CloseInput()
+{
+    // the frame may still point into the source's memory
+    m_TmpFrame.release();
+
+    if( m_Source != NULL )
+    {
+        m_Source->Close();
+        m_Source = NULL;
+    }
+}
+
+//=======================================================================
+bool VideoProcessor::SetRawOutput(
+    const std::string& filename,
+    RawFrameFile::FORMAT format )
+{
+    m_OutputFile = filename;
+    m_Extension.clear();
+
+    return m_RawWriter.Open( m_OutputFile, GetFrameSize(), format );
 }
 
 //=======================================================================
@@ -142,6 +289,7 @@ bool VideoProcessor::SetOutput(
     double framerate,
     bool isColor )
 {
+    m_RawWriter.Close();
     m_OutputFile = filename;
     m_Extension.clear();
 
@@ -178,6 +326,8 @@ bool VideoProcessor::SetOutput(
         return false;
     }
 
+    m_RawWriter.Close();
+
     // filenames and their common m_Extension
     m_OutputFile = filename;
     m_Extension = ext;
@@ -217,180 +367,72 @@ void VideoProcessor::SetFrameProcessor( FrameProcessor* frameProcessorPtr )
 //=======================================================================
 cv::Size VideoProcessor::GetFrameSize()
 {
-    if( m_Images.size() == 0 )
+    if( m_Source == NULL )
     {
-        // get size of from the m_Capture device
-        int w = static_cast<int>( m_Capture.get( CV_CAP_PROP_FRAME_WIDTH ) );
-        int h = static_cast<int>( m_Capture.get( CV_CAP_PROP_FRAME_HEIGHT ) );
+        return cv::Size( 0, 0 );
+    }
 
-		if (m_DownSampleRate > 1)
-		{
-			w /= m_DownSampleRate;
-			h /= m_DownSampleRate;
-		}
+    cv::Size s = m_Source->GetFrameSize();
 
-        return cv::Size( w, h );
-    }
-    else
+    if( m_DownSampleRate > 1 )
     {
-        // if input is vector of images
-        cv::Mat tmp = cv::imread( m_Images[0] );
-        if( !tmp.data )
-        {
-            return cv::Size( 0, 0 );
-        }
-        else
-        {
-			int w = tmp.size().width;
-			int h = tmp.size().height;
-
-			if (m_DownSampleRate > 1)
-			{
-				w /= m_DownSampleRate;
-				h /= m_DownSampleRate;
-			}
-			return cv::Size(w, h);
-        }
+        s.width /= m_DownSampleRate;
+        s.height /= m_DownSampleRate;
     }
+
+    return s;
 }
 
 //=======================================================================
 long VideoProcessor::GetFrameNumber()
 {
-    if( m_Images.size() == 0 )
-    {
-        // get info of from the m_Capture device
-        long f = static_cast<long>( m_Capture.get( CV_CAP_PROP_POS_FRAMES ) );
-        return f;
-    }
-    else
-    {
-        // if input is vector of m_Images
-        return static_cast<long>( m_ItImg - m_Images.begin() );
-    }
+    return m_Source != NULL ? m_Source->GetFrameNumber() : 0;
 }
 
 //=======================================================================
 double VideoProcessor::GetPositionMS()
 {
     // undefined for vector of m_Images
-    if( m_Images.size() != 0 )
-    {
-        return 0.0;
-    }
-
-    double t = m_Capture.get( CV_CAP_PROP_POS_MSEC );
-    return t;
+    return m_Source != NULL ? m_Source->GetPositionMS() : 0.0;
 }
 
 //=======================================================================
 double VideoProcessor::GetFrameRate()
 {
     // undefined for vector of m_Images
-    if( m_Images.size() != 0 )
-    {
-        return 0;
-    }
-
-    double r = m_Capture.get( CV_CAP_PROP_FPS );
-    return r;
+    return m_Source != NULL ? m_Source->GetFrameRate() : 0.0;
 }
 
 //=======================================================================
 long VideoProcessor::GetTotalFrameCount()
 {
-    // for vector of m_Images
-    if( m_Images.size() != 0 )
-    {
-        return static_cast<long>( m_Images.size() );
-    }
-
-    long t = static_cast<long>( m_Capture.get( CV_CAP_PROP_FRAME_COUNT ) );
-    return t;
+    return m_Source != NULL ? m_Source->GetTotalFrameCount() : 0;
 }
 
 //=======================================================================
 int VideoProcessor::GetCodec( char codec[4] )
 {
     // undefined for vector of m_Images
-    if( m_Images.size() != 0 )
-    {
-        return -1;
-    }
-
-    union
-    {
-        int value;
-        char code[4];
-    } returned;
-
-    returned.value = static_cast<int>( m_Capture.get( CV_CAP_PROP_FOURCC ) );
-
-    codec[0] = returned.code[0];
-    codec[1] = returned.code[1];
-    codec[2] = returned.code[2];
-    codec[3] = returned.code[3];
-
-    return returned.value;
+    return m_Source != NULL ? m_Source->GetCodec( codec ) : -1;
 }
 
 //=======================================================================
 bool VideoProcessor::SetFrameNumber( long pos )
 {
-    // for vector of m_Images
-    if( m_Images.size() != 0 )
-    {
-		if (pos > m_Images.size())
-		{
-			return false;
-		}
-		else
-		{
-			// move to position in vector
-			m_ItImg = m_Images.begin() + pos;
-			return true;
-		}
-    }
-    else
-    {
-        // if input is a m_Capture device
-		//return m_Capture.set( CV_CAP_PROP_POS_FRAMES, pos );
-		return true;
-    }
+    return m_Source != NULL && m_Source->SetFrameNumber( pos );
 }
 
 //=======================================================================
 bool VideoProcessor::SetPositionMS( double pos )
 {
     // not defined in vector of m_Images
-    if( m_Images.size() != 0 )
-    {
-        return false;
-    }
-    else
-    {
-        return m_Capture.set( CV_CAP_PROP_POS_MSEC, pos );
-    }
+    return m_Source != NULL && m_Source->SetPositionMS( pos );
 }
 
 //=======================================================================
 bool VideoProcessor::SetRelativePosition( double pos )
 {
-    // for vector of m_Images
-    if( m_Images.size() != 0 )
-    {
-        // move to position in vector
-        long posI = static_cast<long>( pos*m_Images.size() + 0.5 );
-        m_ItImg = m_Images.begin() + posI;
-
-        // is it a valid position?
-        return posI < m_Images.size();
-    }
-    else
-    {
-        // if input is a m_Capture device
-        return m_Capture.set( CV_CAP_PROP_POS_AVI_RATIO, pos );
-    }
+    return m_Source != NULL && m_Source->SetRelativePosition( pos );
 }// SetRelativePosition
 
 //=======================================================================
@@ -400,6 +442,8 @@ void VideoProcessor::Run()
     cv::Mat frame;
     // output frame
     cv::Mat output;
+    // current frame's envelope
+    FrameInfo info;
 
     // if no m_Capture device has been set
     if( !IsOpened() )
@@ -409,10 +453,51 @@ void VideoProcessor::Run()
 
     m_Stop = false;
 
+    // the time line starts with the first frame of this run
+    m_Clock.Reset();
+
+    if( m_Headless )
+    {
+        // Ctrl+C, or "q" on stdin
+        StopChannel::Open();
+    }
+
+    // debug build: count allocations made by the frame loop after warm-up
+    AllocCounter::Install();
+    AllocCounter::SetCounting( true );
+    long matAllocsAfterWarmUp = 0;
+    long heapAllocsAfterWarmUp = 0;
+    int numAllocReports = 0;
+
+    if( m_ThreadedCapture )
+    {
+        StartCapture();
+    }
+
+    if( m_AsyncOutput && m_OutputFile.length() != 0 && !m_RawWriter.IsOpened() )
+    {
+        m_AsyncWriter.Start(
+            [this]( const cv::Mat& f, const FrameInfo& ) { EncodeFrame( f ); },
+            m_OutputQueueDepth,
+            m_OutputPolicy );
+    }
+
     while( !IsStopped() )
     {
+        const long matAllocs = AllocCounter::GetNumMatAllocs();
+        const long heapAllocs = AllocCounter::GetNumHeapAllocs();
+
+        if( m_Headless )
+        {
+            if( StopChannel::IsStopRequested() )
+            {
+                StopIt();
+                break;
+            }
+        }
+#ifdef _WIN32
 		// if there's no window created, hit Esc on the command window should also exit
-		if ( _kbhit() )
+		else if ( _kbhit() )
 		{
 			int key = _getch();
 			if ( key == 27/*Esc*/ )
@@ -420,17 +505,23 @@ void VideoProcessor::Run()
 				StopIt();
 			}
 		}
+#endif // _WIN32
 
         // read next frame if any
-        if( !ReadNextFrame( frame ) )
+        const bool ok = m_ThreadedCapture ?
+            m_FrameRing.ReadLatest( frame, info, m_CaptureTimeout ) : ReadNextFrame( frame, info );
+
+        if( !ok )
         {
             break;
         }
 
+        info.m_DequeueTime = FrameInfo::Now();
+
         // display input frame
-        if( m_WindowNameInput.length() != 0 )
+        if( !m_Headless && m_WindowNameInput.length() != 0 )
         {
-            cv::imshow( m_WindowNameInput, frame );
+            cv::imshow( m_WindowNameInput, ToBgr( frame, m_BgrInput ) );
         }
 
         // calling the m_Process function or method
@@ -443,7 +534,7 @@ void VideoProcessor::Run()
             }
             else if( m_FrameProcessor )
             {
-                m_FrameProcessor->Process( frame, output );
+                m_FrameProcessor->Process( frame, output, info );
             }
         }
         else
@@ -457,38 +548,96 @@ void VideoProcessor::Run()
         // write output sequence
         if( m_OutputFile.length() != 0 )
         {
-            WriteNextFrame( output );
+            WriteNextFrame( output, info );
         }
 
         // display output frame
-        if( m_WindowNameOutput.length() != 0 )
+        if( !m_Headless && m_WindowNameOutput.length() != 0 )
         {
-            cv::imshow( m_WindowNameOutput, output );
+            cv::imshow( m_WindowNameOutput, ToBgr( output, m_BgrOutput ) );
         }
 
         // introduce a delay
-        if( m_Delay >= 0 )
+        // (headless: no event loop to run, go on as soon as the next frame is there)
+        if( !m_Headless )
         {
-            int ret = cv::waitKey( m_Delay );
-            if( ret == 27/*ESC*/ )
+            if( m_Delay >= 0 )
             {
-                StopIt();
+                int ret = cv::waitKey( m_Delay );
+                if( ret == 27/*ESC*/ )
+                {
+                    StopIt();
+                }
+			    //debug
+			    //if ( ret == 104 || ret == 72/*H/h, "home"*/ )
+			    //{
+			    //	m_FrameProcessor->m_Debug = true;
+			    //}
+            }
+            else
+            {
+                cv::waitKey( m_Delay );
             }
-			//debug
-			//if ( ret == 104 || ret == 72/*H/h, "home"*/ )
-			//{
-			//	m_FrameProcessor->m_Debug = true;
-			//}
         }
-        else
+
+        if( m_TotalFrame > WARM_UP_FRAMES )
         {
-            cv::waitKey( m_Delay );
+            const long newMatAllocs = AllocCounter::GetNumMatAllocs() - matAllocs;
+            const long newHeapAllocs = AllocCounter::GetNumHeapAllocs() - heapAllocs;
+            matAllocsAfterWarmUp += newMatAllocs;
+            heapAllocsAfterWarmUp += newHeapAllocs;
+
+#ifdef _DEBUG
+            if( ( newMatAllocs > 0 || newHeapAllocs > 0 ) && numAllocReports++ < MAX_ALLOC_REPORTS )
+            {
+                std::cout << "frame " << info.m_Index << ": " << newMatAllocs << " image buffers, "
+                    << newHeapAllocs << " heap blocks allocated" << std::endl;
+            }
+#endif // _DEBUG
         }
 
         // check if we should stop
-        if( m_FrameToStop >= 0 && GetFrameNumber() == m_FrameToStop )
+        // (the capture device belongs to the capture thread, so use the ring's frame count)
+        const long frameNumber = m_ThreadedCapture ?
+            m_FrameRing.GetLastReadIndex() : GetFrameNumber();
+
+        if( m_FrameToStop >= 0 && frameNumber == m_FrameToStop )
         {
             StopIt();
         }
     }
+
+    AllocCounter::SetCounting( false );
+
+    if( m_ThreadedCapture )
+    {
+        StopCapture();
+
+        std::cout << "captured " << m_FrameRing.GetNumWritten()
+            << ", dropped " << m_FrameRing.GetNumDropped()
+            << ", duplicated " << m_FrameRing.GetNumDuplicated() << " frames" << std::endl;
+    }
+
+    if( m_AsyncWriter.IsRunning() )
+    {
+        // write out the frames still queued
+        m_AsyncWriter.Stop();
+
+        std::cout << "written " << m_AsyncWriter.GetNumWritten()
+            << ", dropped " << m_AsyncWriter.GetNumDropped()
+            << " frames, max queue depth " << m_AsyncWriter.GetMaxQueueDepth()
+            << ", encode time avg " << m_AsyncWriter.GetAvgEncodeTime()
+            << " ms, max " << m_AsyncWriter.GetMaxEncodeTime() << " ms" << std::endl;
+    }
+
+    // write the time stamp index, the recording is complete
+    m_RawWriter.Close();
+
+#ifdef _DEBUG
+    std::cout << "after warm-up: " << matAllocsAfterWarmUp << " image buffers, "
+        << heapAllocsAfterWarmUp << " heap blocks allocated" << std::endl;
+
+    // the steady-state loop must not allocate
+    CV_Assert( matAllocsAfterWarmUp == 0 && heapAllocsAfterWarmUp == 0 );
+#endif // _DEBUG
 } // Run
\ No newline at end of file
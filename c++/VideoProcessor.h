@@ -5,10 +5,22 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <thread>
+#include <atomic>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include "FrameRing.h"
+#include "AsyncFrameWriter.h"
+#include "RawFrameWriter.h"
+#include "FrameSource.h"
+#include "CaptureSource.h"
+#include "ImageListSource.h"
+#include "RawFileSource.h"
+#include "FrameInfo.h"
+#include "Clock.h"
+
 // The frame processor interface
 class FrameProcessor
 {
@@ -17,7 +29,16 @@ public:
 	{}
 
 	// processing method
-    virtual void Process( cv::Mat &input, cv::Mat &output ) = 0;
+	// info: index and time stamps of the input frame
+    virtual void Process( cv::Mat &input, cv::Mat &output, const FrameInfo& info ) = 0;
+
+	// whether Process() takes YUYV (CV_8UC2) frames as they come from the source.
+	// Otherwise they're converted to BGR first
+	virtual bool AcceptsYuyv() const
+	{
+		return false;
+	}
+
 	bool m_Debug;
 }; // class FrameProcessor
 
@@ -27,15 +48,26 @@ public:
     // Constructor setting the default values
     VideoProcessor();
 
+    ~VideoProcessor();
+
     // set the name of the video file
     bool SetInput( std::string filename );
 
     // set the camera ID
-    bool SetInput( int id );
+    // yuyv: capture YUYV, unconverted (see FrameProcessor::AcceptsYuyv)
+    bool SetInput( int id, bool yuyv = false );
 
     // set the vector of input m_Images
     void SetInput( const std::vector<std::string>& imgs );
 
+    // set a raw frame recording (see RawFrameFile.h) as input.
+    // the file is memory-mapped and its frames are processed without copying
+    bool SetRawInput( const std::string& filename );
+
+    // set any other frame source, e.g. a SyntheticTableSource.
+    // the source is not owned, it must outlive the processing
+    void SetInput( FrameSource* source );
+
     // set the output video file
     // by default the same parameters than input video will be used
     bool SetOutput(
@@ -52,6 +84,12 @@ public:
         int numberOfDigits = 3,   // number of digits
         int startIndex = 0 );
 
+    // record the output frames to a raw frame file (see RawFrameFile.h)
+    // frames must be CV_8UC3 for BGR, CV_8UC2 for YUYV
+    bool SetRawOutput(
+        const std::string& filename,
+        RawFrameFile::FORMAT format = RawFrameFile::BGR );
+
     // set the callback function that will be called for each frame
     void SetFrameProcessor( void( *frameProcessingCallback ) ( cv::Mat&, cv::Mat& ) );
 
@@ -149,7 +187,7 @@ public:
     // Is a m_Capture device opened?
     bool IsOpened()
     {
-        return m_Capture.isOpened() || !m_Images.empty();
+        return m_Source != NULL && m_Source->IsOpened();
     }
 
     void SetInitPosX( int x )
@@ -175,6 +213,79 @@ public:
     // to grab (and Process) the frames of the sequence
     void Run();
 
+    // capture on a separate thread into a ring of numSlots frames.
+    // The processing loop always gets the newest frame, stale ones are dropped.
+    // Meant for live input (webcam); offline input should keep every frame
+    void SetThreadedCapture( bool ok, unsigned int numSlots = 3 )
+    {
+        m_ThreadedCapture = ok;
+        m_NumCaptureSlots = numSlots;
+    }
+
+    // how long (ms) the processing loop waits for a new captured frame before
+    // it processes the previous one again. negative means wait until one arrives
+    void SetCaptureTimeout( int t )
+    {
+        m_CaptureTimeout = t;
+    }
+
+    // number of captured frames that were never processed (threaded capture only)
+    long GetNumDroppedFrames() const
+    {
+        return m_FrameRing.GetNumDropped();
+    }
+
+    // number of frames that were processed more than once (threaded capture only)
+    long GetNumDuplicatedFrames() const
+    {
+        return m_FrameRing.GetNumDuplicated();
+    }
+
+    // decode image input ahead of the processing loop on numThreads worker threads,
+    // at most depth frames ahead. Frames are still processed strictly in order.
+    // numThreads = 0 decodes each image on the processing loop when it's needed
+    void SetDecodeAhead( unsigned int numThreads, unsigned int depth )
+    {
+        m_ImageListSource.SetDecodeAhead( numThreads, depth );
+    }
+
+    // encode the output frames on a background thread through a queue of depth frames.
+    // policy: what to do when the queue is full (wait, or drop the oldest/newest frame)
+    void SetAsyncOutput(
+        bool ok,
+        unsigned int depth = 8,
+        AsyncFrameWriter::POLICY policy = AsyncFrameWriter::BLOCK )
+    {
+        m_AsyncOutput = ok;
+        m_OutputQueueDepth = depth;
+        m_OutputPolicy = policy;
+    }
+
+    // how frames are time-stamped: real time (live), paced to the recording,
+    // or virtual time as fast as possible (see Clock)
+    void SetClockMode( Clock::MODE m )
+    {
+        m_Clock.SetMode( m );
+    }
+
+    // PACED clock: replay speed, 1 = as recorded
+    void SetReplaySpeed( double s )
+    {
+        m_Clock.SetSpeed( s );
+    }
+
+    // run without a screen: no HighGUI calls at all (windows, waitKey), no delay between
+    // frames. Stop with Ctrl+C or by typing "q" on stdin (see StopChannel)
+    void SetHeadless( bool ok )
+    {
+        m_Headless = ok;
+    }
+
+    bool IsHeadless() const
+    {
+        return m_Headless;
+    }
+
     // the image will be down-sampled by 1/t in both width and height
     void SetDownSampleRate( unsigned int t )
     {
@@ -194,8 +305,17 @@ public:
 
 private:
 
-    // the OpenCV video m_Capture object
-    cv::VideoCapture m_Capture;
+    // the source frames are read from, one of the sources below or an external one
+    FrameSource* m_Source;
+
+    // video file or camera
+    CaptureSource m_CaptureSource;
+
+    // vector of image files
+    ImageListSource m_ImageListSource;
+
+    // raw frame recording
+    RawFileSource m_RawSource;
 
     // the callback function to be called
     // for the processing of each frame
@@ -230,15 +350,25 @@ private:
     // to stop the processing
     bool m_Stop;
 
-    // vector of image filename to be used as input
-    std::vector<std::string> m_Images;
+    // no HighGUI calls in the frame loop
+    bool m_Headless;
+
+    // stamps the capture time of every frame
+    Clock m_Clock;
 
-    // image vector iterator
-    std::vector<std::string>::const_iterator m_ItImg;
+    // BGR conversion of a frame in another pixel format
+    cv::Mat m_BgrFrame;
+
+    // BGR conversions of YUYV frames handed through, to show or encode them
+    cv::Mat m_BgrInput;
+    cv::Mat m_BgrOutput;
 
     // the OpenCV video writer object
     cv::VideoWriter m_Writer;
 
+    // raw frame recording used as output
+    RawFrameWriter m_RawWriter;
+
     // output filename
     std::string m_OutputFile;
 
@@ -251,6 +381,18 @@ private:
     // extension of output Images
     std::string m_Extension;
 
+    // whether output frames are encoded on the writer thread
+    bool m_AsyncOutput;
+
+    // number of output frames queued at most
+    unsigned int m_OutputQueueDepth;
+
+    // what to do with an output frame when the queue is full
+    AsyncFrameWriter::POLICY m_OutputPolicy;
+
+    // encodes the output frames in the background
+    AsyncFrameWriter m_AsyncWriter;
+
     // extract only portion of the image
     int m_InitPosX;
 
@@ -262,13 +404,57 @@ private:
 
     cv::Mat m_TmpFrame; // tmp frame
 
-    // to get the next frame
-    // could be: video file; camera; vector of m_Images
-    bool ReadNextFrame( cv::Mat& frame );
+    // frame workspace, allocated once per resolution and reused every frame
+    cv::Mat m_CropFrame;    // extracted portion of m_TmpFrame
+    cv::Mat m_ResizeFrame;  // down-sampled frame
+
+    // whether capture runs on its own thread
+    bool m_ThreadedCapture;
+
+    // number of slots in the capture ring
+    unsigned int m_NumCaptureSlots;
+
+    // ms to wait for a new captured frame
+    int m_CaptureTimeout;
+
+    // latest-frame ring between the capture thread and the processing loop
+    FrameRing m_FrameRing;
+
+    // capture thread
+    std::thread m_CaptureThread;
+
+    // to stop the capture thread
+    std::atomic<bool> m_StopCapture;
+
+    cv::Mat m_CaptureFrame; // frame read by the capture thread
+
+    FrameInfo m_CaptureInfo; // envelope of m_CaptureFrame
+
+    // to close the current source, if any
+    void CloseInput();
+
+    // to get the next frame from m_Source, and stamp its envelope
+    bool ReadNextFrame( cv::Mat& frame, FrameInfo& info );
+
+    // whether YUYV frames of the source go to the frame processor as they are
+    bool PassesYuyv() const;
+
+    // frame itself if it's BGR, otherwise its conversion in bgr
+    static const cv::Mat& ToBgr( const cv::Mat& frame, cv::Mat& bgr );
+
+    // capture thread body: read frames into m_FrameRing until stopped or out of frames
+    void CaptureLoop();
+
+    void StartCapture();
+
+    void StopCapture();
+
+    // to write the output frame, or queue it for the writer thread
+    void WriteNextFrame( cv::Mat& frame, const FrameInfo& info );
 
-    // to write the output frame
+    // to encode the output frame
     // could be: video file or m_Images
-    void WriteNextFrame( cv::Mat& frame );
+    void EncodeFrame( const cv::Mat& frame );
 
 }; // class VideoProcessor
 
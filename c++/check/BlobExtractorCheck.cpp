@@ -0,0 +1,199 @@
+//===================================================================================
+// Self-check of BlobExtractor against a brute-force flood fill, on random masks.
+// Both Extract() overloads (cv::Mat and BitMask) must give the same blobs as the
+// flood fill: area, sums of the coordinates and of their products, bounding box
+// and crack length.
+// Not part of the bot: a program of its own, e.g.
+//   g++ -O2 -I.. BlobExtractorCheck.cpp ../BlobExtractor.cpp ../BitMask.cpp -lopencv_core
+//===================================================================================
+#include "BlobExtractor.h"
+#include "BitMask.h"
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//===================================================================================
+// 8-connected components of the non-zero pixels, one pixel at a time
+static void FloodFill( const cv::Mat& bin, std::vector<Blob>& blobs, const cv::Point& offset )
+{
+	blobs.clear();
+
+	std::vector<int> label( bin.rows * bin.cols, -1 );
+	std::vector<cv::Point> stack;
+
+	for ( int y = 0; y < bin.rows; y++ )
+	{
+		for ( int x = 0; x < bin.cols; x++ )
+		{
+			if ( bin.ptr<uchar>( y )[x] == 0 || label[y * bin.cols + x] >= 0 )
+			{
+				continue;
+			}
+
+			Blob blob;
+			int minX = x, minY = y, maxX = x, maxY = y;
+
+			label[y * bin.cols + x] = static_cast<int>( blobs.size() );
+			stack.push_back( cv::Point( x, y ) );
+
+			while ( !stack.empty() )
+			{
+				const cv::Point p = stack.back();
+				stack.pop_back();
+
+				const double px = p.x + offset.x;
+				const double py = p.y + offset.y;
+
+				blob.m_Area++;
+				blob.m_SumX += px;
+				blob.m_SumY += py;
+				blob.m_SumXX += px * px;
+				blob.m_SumYY += py * py;
+				blob.m_SumXY += px * py;
+
+				minX = std::min( minX, p.x );
+				minY = std::min( minY, p.y );
+				maxX = std::max( maxX, p.x );
+				maxY = std::max( maxY, p.y );
+
+				for ( int dy = -1; dy <= 1; dy++ )
+				{
+					for ( int dx = -1; dx <= 1; dx++ )
+					{
+						const int nx = p.x + dx;
+						const int ny = p.y + dy;
+						const bool inside = nx >= 0 && nx < bin.cols && ny >= 0 && ny < bin.rows;
+						const bool set = inside && bin.ptr<uchar>( ny )[nx] != 0;
+
+						// an edge to the background or out of the image
+						if ( ( dx == 0 ) != ( dy == 0 ) && !set )
+						{
+							blob.m_CrackLength++;
+						}
+
+						if ( set && label[ny * bin.cols + nx] < 0 )
+						{
+							label[ny * bin.cols + nx] = static_cast<int>( blobs.size() );
+							stack.push_back( cv::Point( nx, ny ) );
+						}
+					}
+				}
+			}
+
+			blob.m_BoundingBox = cv::Rect( minX + offset.x, minY + offset.y, maxX - minX + 1, maxY - minY + 1 );
+			blobs.push_back( blob );
+		}
+	}
+} // FloodFill
+
+//===================================================================================
+// any order, as long as both lists are sorted the same way
+static bool Less( const Blob& a, const Blob& b )
+{
+	if ( a.m_Area != b.m_Area ) return a.m_Area < b.m_Area;
+	if ( a.m_SumX != b.m_SumX ) return a.m_SumX < b.m_SumX;
+	return a.m_SumY < b.m_SumY;
+} // Less
+
+//===================================================================================
+// the sums are of integers, well within a double's mantissa: exact
+static bool Same( const Blob& a, const Blob& b )
+{
+	return a.m_Area == b.m_Area &&
+		a.m_SumX == b.m_SumX && a.m_SumY == b.m_SumY &&
+		a.m_SumXX == b.m_SumXX && a.m_SumYY == b.m_SumYY && a.m_SumXY == b.m_SumXY &&
+		a.m_BoundingBox.x == b.m_BoundingBox.x && a.m_BoundingBox.y == b.m_BoundingBox.y &&
+		a.m_BoundingBox.width == b.m_BoundingBox.width && a.m_BoundingBox.height == b.m_BoundingBox.height &&
+		a.m_CrackLength == b.m_CrackLength;
+} // Same
+
+//===================================================================================
+static bool Compare( std::vector<Blob> found, std::vector<Blob> expected )
+{
+	if ( found.size() != expected.size() )
+	{
+		return false;
+	}
+
+	std::sort( found.begin(), found.end(), Less );
+	std::sort( expected.begin(), expected.end(), Less );
+
+	for ( size_t i = 0; i < found.size(); i++ )
+	{
+		if ( !Same( found[i], expected[i] ) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+} // Compare
+
+//===================================================================================
+int main()
+{
+	// widths around the 64 pixel words of BitMask
+	const int widths[] = { 1, 2, 31, 63, 64, 65, 127, 128, 130, 200 };
+	const double densities[] = { 0.05, 0.3, 0.5, 0.6, 0.8, 1.0 };
+	const int numRuns = 20;
+
+	std::mt19937 rng( 1 );
+	std::uniform_real_distribution<double> uniform( 0.0, 1.0 );
+
+	BlobExtractor extractor;
+	BitMask bits;
+	std::vector<Blob> expected, fromMat, fromBits;
+
+	int numChecks = 0;
+	int numFailed = 0;
+
+	for ( const int width : widths )
+	{
+		for ( const double density : densities )
+		{
+			for ( int run = 0; run < numRuns; run++ )
+			{
+				const int height = 1 + static_cast<int>( uniform( rng ) * 80 );
+				const cv::Point offset( run * 7, run * 3 );
+
+				cv::Mat bin( height, width, CV_8UC1 );
+				for ( int y = 0; y < height; y++ )
+				{
+					for ( int x = 0; x < width; x++ )
+					{
+						bin.ptr<uchar>( y )[x] = uniform( rng ) < density ? 255 : 0;
+					}
+				}
+
+				FloodFill( bin, expected, offset );
+
+				extractor.Extract( bin, fromMat, offset );
+
+				bits.Pack( bin );
+				extractor.Extract( bits, fromBits, offset );
+
+				numChecks += 2;
+
+				if ( !Compare( fromMat, expected ) )
+				{
+					numFailed++;
+					std::cout << "cv::Mat differs: " << width << " x " << height << ", density " << density << std::endl;
+				}
+
+				if ( !Compare( fromBits, expected ) )
+				{
+					numFailed++;
+					std::cout << "BitMask differs: " << width << " x " << height << ", density " << density << std::endl;
+				}
+			}
+		}
+	}
+
+	std::cout << numChecks - numFailed << " / " << numChecks << " masks match the flood fill" << std::endl;
+
+	return numFailed == 0 ? 0 : 1;
+} // main
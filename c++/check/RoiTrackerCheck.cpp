@@ -0,0 +1,111 @@
+//===================================================================================
+// Self-check of RoiTracker on a simulated puck: most searches must cover less than
+// RoiTracker::SMALL_SEARCH (5%) of the table, and the window must keep the puck.
+// The puck is hit from both ends at 0.3 - 2.5 m/s, bounces off the side walls, slows
+// down, and is missed now and then; the camera runs at 60 fps, the table is 540 x 320
+// pixels. The window is predicted the way BotManager::PredictNextPos() does it.
+// Not part of the bot: a program of its own, e.g.
+//   g++ -O2 -I.. RoiTrackerCheck.cpp ../RoiTracker.cpp -lopencv_core
+//===================================================================================
+#include "RoiTracker.h"
+
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <random>
+
+#define LENGTH			1003.0	// mm, along x
+#define WIDTH			597.0	// mm, along y
+#define SCALE			0.54	// pixels / mm
+#define FRAME_TIME		16.7	// ms
+#define RESTITUTION		0.85	// of the speed, at a wall
+#define DECAY			0.995	// of the speed, per frame
+#define HIT_ZONE		100.0	// mm from either end, where the puck is hit back
+#define MISS_RATE		0.02	// occluded, not found even in the window
+#define NUM_FRAMES		20000
+
+#define MIN_SMALL_RATE	0.8		// of the searches under SMALL_SEARCH
+#define MIN_HIT_RATE	0.95	// of the window searches
+
+//===================================================================================
+int main()
+{
+	std::mt19937 rng( 1 );
+	std::uniform_real_distribution<double> uniform( 0.0, 1.0 );
+
+	const cv::Rect bounds( 0, 0, static_cast<int>( LENGTH * SCALE ), static_cast<int>( WIDTH * SCALE ) );
+
+	RoiTracker tracker;
+	tracker.SetEnabled( true );
+
+	// mm, mm/ms
+	double x = LENGTH / 2.0, y = WIDTH / 2.0;
+	double vx = 1.0, vy = 0.3;
+
+	bool prevFound = false;
+	cv::Point prevPos;
+
+	for ( int frame = 0; frame < NUM_FRAMES; frame++ )
+	{
+		// move, bouncing off the side walls
+		x += vx * FRAME_TIME;
+		y += vy * FRAME_TIME;
+		vx *= DECAY;
+		vy *= DECAY;
+
+		if ( y < 0.0 || y > WIDTH )
+		{
+			y = y < 0.0 ? -y : 2.0 * WIDTH - y;
+			vy = -vy * RESTITUTION;
+			vx *= RESTITUTION;
+		}
+
+		// hit back towards the other end
+		if ( ( x < HIT_ZONE && vx <= 0.0 ) || ( x > LENGTH - HIT_ZONE && vx >= 0.0 ) )
+		{
+			const double speed = 0.3 + 2.2 * uniform( rng );
+			const double angle = ( uniform( rng ) - 0.5 ) * 1.5;
+			const double dir = x < HIT_ZONE ? 1.0 : -1.0;
+
+			x = std::min( std::max( x, 0.0 ), LENGTH );
+			vx = dir * speed * std::cos( angle );
+			vy = speed * std::sin( angle );
+		}
+
+		const cv::Point pos( static_cast<int>( x * SCALE ), static_cast<int>( y * SCALE ) );
+
+		// search the window, or the whole table
+		cv::Rect win;
+		const bool tracked = tracker.GetWindow( bounds, win );
+		if ( !tracked )
+		{
+			win = bounds;
+		}
+
+		const bool found = win.contains( pos ) && uniform( rng ) >= MISS_RATE;
+		tracker.Update( tracked, found, static_cast<double>( win.area() ) / bounds.area() );
+
+		if ( found )
+		{
+			// the same move again, none yet on a new track
+			const cv::Point step = prevFound ? pos - prevPos : cv::Point();
+			tracker.Predict( pos + step, static_cast<float>( cv::norm( step ) ) );
+
+			prevPos = pos;
+		}
+
+		prevFound = found;
+	}
+
+	std::cout << tracker.GetNumHits() << " hits in " << tracker.GetNumTracked() << " window searches (hit rate "
+		<< tracker.GetHitRate() * 100.0 << "%), " << tracker.GetNumFullSearches() << " full searches, "
+		<< tracker.GetSearchedFraction() * 100.0 << "% of the pixels searched on average, "
+		<< tracker.GetSmallSearchRate() * 100.0 << "% of the searches under "
+		<< RoiTracker::SMALL_SEARCH * 100.0 << "% of the pixels" << std::endl;
+
+	const bool ok = tracker.GetSmallSearchRate() >= MIN_SMALL_RATE && tracker.GetHitRate() >= MIN_HIT_RATE;
+
+	std::cout << ( ok ? "ok" : "FAILED" ) << std::endl;
+
+	return ok ? 0 : 1;
+} // main
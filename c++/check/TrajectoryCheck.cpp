@@ -0,0 +1,195 @@
+//===================================================================================
+// Self-check of Trajectory against a puck stepped through time: the crossing of a y
+// line (where, when, how many bounces, how fast) and the bounce points and times, for
+// 0, 1 and several bounces, elastic or not, with and without drag.
+// Not part of the bot: a program of its own, e.g.
+//   g++ -O2 -I.. TrajectoryCheck.cpp ../Trajectory.cpp -lopencv_core
+//===================================================================================
+#include "Trajectory.h"
+
+#include <opencv2/core.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#define LEFT		30.0	// mm, the puck's center between the side walls
+#define RIGHT		567.0
+#define STEP		0.01	// ms, of the simulation
+#define MAX_TIME	20000.0	// ms
+#define MAX_BOUNCES	16
+
+#define POS_TOL		0.5		// mm
+#define TIME_TOL	0.2		// ms
+#define SPEED_TOL	0.002	// mm/ms
+
+//===================================================================================
+// what the simulation saw, up to line y
+struct Path
+{
+	bool					m_Crossed;
+	Trajectory::Crossing	m_Crossing;
+	std::vector<cv::Point2f> m_Bounces;
+	std::vector<float>		m_BounceTimes;
+}; // Path
+
+//===================================================================================
+// small time steps, the drag as an exponential decay, the walls as reflections
+static void Simulate(
+	Path& path,
+	const cv::Point2f& pos,
+	const cv::Point2f& speed,
+	const double e,
+	const double drag,
+	const double lineY )
+{
+	double x = pos.x, y = pos.y;
+	double vx = speed.x, vy = speed.y;
+	const double decay = std::exp( -drag * STEP );
+
+	path.m_Crossed = false;
+	path.m_Bounces.clear();
+	path.m_BounceTimes.clear();
+
+	for ( double t = 0.0; t < MAX_TIME; t += STEP )
+	{
+		const double nx = x + vx * STEP;
+		const double ny = y + vy * STEP;
+
+		// the line first, if it's crossed in this step
+		if ( ( ny - lineY ) * ( y - lineY ) <= 0.0 && ny != y )
+		{
+			const double f = ( lineY - y ) / ( ny - y );
+
+			path.m_Crossed = true;
+			path.m_Crossing.m_Pos = cv::Point2f( static_cast<float>( x + f * ( nx - x ) ), static_cast<float>( lineY ) );
+			path.m_Crossing.m_Time = static_cast<float>( t + f * STEP );
+			path.m_Crossing.m_NumBounces = static_cast<int>( path.m_Bounces.size() );
+			path.m_Crossing.m_Speed = cv::Point2f( static_cast<float>( vx ), static_cast<float>( vy ) );
+			return;
+		}
+
+		if ( nx < LEFT || nx > RIGHT )
+		{
+			// where and when it reached the wall
+			const double wall = nx < LEFT ? LEFT : RIGHT;
+			const double f = ( wall - x ) / ( nx - x );
+
+			path.m_Bounces.push_back( cv::Point2f( static_cast<float>( wall ), static_cast<float>( y + f * ( ny - y ) ) ) );
+			path.m_BounceTimes.push_back( static_cast<float>( t + f * STEP ) );
+
+			x = 2.0 * wall - nx;
+			vx = -vx * e;
+			vy = vy * e;
+		}
+		else
+		{
+			x = nx;
+		}
+
+		y = ny;
+		vx *= decay;
+		vy *= decay;
+
+		if ( std::abs( vx ) + std::abs( vy ) < 1e-6 )
+		{
+			return;
+		}
+	}
+} // Simulate
+
+//===================================================================================
+static bool Near( const double a, const double b, const double tol )
+{
+	return std::abs( a - b ) <= tol;
+} // Near
+
+//===================================================================================
+// one case: @return true if Trajectory agrees with the simulation
+static bool Check(
+	const char* name,
+	const cv::Point2f& pos,
+	const cv::Point2f& speed,
+	const float e,
+	const float drag,
+	const float lineY,
+	const int expectedBounces )
+{
+	Trajectory traj;
+	traj.SetWalls( static_cast<float>( LEFT ), static_cast<float>( RIGHT ) );
+	traj.SetRestitution( e );
+	traj.SetFriction( drag );
+	traj.Solve( pos, speed );
+
+	Path path;
+	Simulate( path, pos, speed, e, drag, lineY );
+
+	Trajectory::Crossing crossing;
+	const bool crossed = traj.CrossY( lineY, crossing );
+
+	cv::Point2f points[MAX_BOUNCES];
+	float times[MAX_BOUNCES];
+	const int numBounces = traj.GetBounces( lineY, points, times, MAX_BOUNCES );
+
+	bool ok = crossed == path.m_Crossed;
+
+	if ( ok && crossed )
+	{
+		const Trajectory::Crossing& c = path.m_Crossing;
+
+		ok = crossing.m_NumBounces == expectedBounces &&
+			c.m_NumBounces == expectedBounces &&
+			numBounces == expectedBounces &&
+			Near( crossing.m_Pos.x, c.m_Pos.x, POS_TOL ) &&
+			Near( crossing.m_Time, c.m_Time, TIME_TOL ) &&
+			Near( crossing.m_Speed.x, c.m_Speed.x, SPEED_TOL ) &&
+			Near( crossing.m_Speed.y, c.m_Speed.y, SPEED_TOL );
+
+		for ( int k = 0; ok && k < numBounces && k < MAX_BOUNCES; k++ )
+		{
+			ok = Near( points[k].x, path.m_Bounces[k].x, POS_TOL ) &&
+				Near( points[k].y, path.m_Bounces[k].y, POS_TOL ) &&
+				Near( times[k], path.m_BounceTimes[k], TIME_TOL );
+		}
+	}
+	else if ( ok )
+	{
+		// never reached: no bounces to tell
+		ok = expectedBounces < 0 && numBounces == -1;
+	}
+
+	std::cout << ( ok ? "ok     " : "FAILED " ) << name;
+	if ( crossed )
+	{
+		std::cout << ": " << crossing.m_NumBounces << " bounces, x " << crossing.m_Pos.x
+			<< " ( " << path.m_Crossing.m_Pos.x << " ), t " << crossing.m_Time
+			<< " ( " << path.m_Crossing.m_Time << " )";
+	}
+	std::cout << std::endl;
+
+	return ok;
+} // Check
+
+//===================================================================================
+int main()
+{
+	const float drag = 1.0f / 3000.0f; // 1/ms, tau = 3 s
+
+	int numFailed = 0;
+
+	numFailed += !Check( "0 bounces, elastic", cv::Point2f( 300, 800 ), cv::Point2f( 0.2f, -1.5f ), 1.0f, 0.0f, 100.0f, 0 );
+	numFailed += !Check( "0 bounces, drag", cv::Point2f( 300, 800 ), cv::Point2f( 0.2f, -1.5f ), 0.83f, drag, 100.0f, 0 );
+	numFailed += !Check( "straight along y, drag", cv::Point2f( 300, 800 ), cv::Point2f( 0.0f, -1.0f ), 0.83f, drag, 100.0f, 0 );
+	numFailed += !Check( "1 bounce, elastic", cv::Point2f( 300, 800 ), cv::Point2f( 0.6f, -1.5f ), 1.0f, 0.0f, 100.0f, 1 );
+	numFailed += !Check( "1 bounce, restitution", cv::Point2f( 300, 800 ), cv::Point2f( 0.6f, -1.5f ), 0.83f, 0.0f, 100.0f, 1 );
+	numFailed += !Check( "1 bounce, restitution and drag", cv::Point2f( 300, 800 ), cv::Point2f( 0.6f, -1.5f ), 0.83f, drag, 100.0f, 1 );
+	numFailed += !Check( "5 bounces, elastic", cv::Point2f( 100, 50 ), cv::Point2f( -2.0f, 0.5f ), 1.0f, 0.0f, 700.0f, 5 );
+	numFailed += !Check( "5 bounces, restitution", cv::Point2f( 100, 50 ), cv::Point2f( -2.0f, 0.5f ), 0.83f, 0.0f, 700.0f, 5 );
+	numFailed += !Check( "4 bounces, restitution and drag", cv::Point2f( 100, 50 ), cv::Point2f( -2.5f, 0.8f ), 0.83f, drag, 650.0f, 4 );
+	numFailed += !Check( "stops before the line", cv::Point2f( 300, 800 ), cv::Point2f( 0.0f, -0.1f ), 0.83f, drag, 100.0f, -1 );
+	numFailed += !Check( "line behind", cv::Point2f( 300, 800 ), cv::Point2f( 0.3f, 1.0f ), 0.83f, drag, 100.0f, -1 );
+
+	std::cout << ( numFailed == 0 ? "all cases match the simulation" : "some cases differ from the simulation" ) << std::endl;
+
+	return numFailed == 0 ? 0 : 1;
+} // main